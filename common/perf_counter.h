@@ -0,0 +1,285 @@
+#ifndef ALGORITHMS_PERF_COUNTER_H
+#define ALGORITHMS_PERF_COUNTER_H
+
+/*
+ *  Copyright(c) 2018 Gang Zhang
+ *  All rights reserved.
+ *  Author: Gang Zhang
+ *  Creation date: 2026.10.17
+ *  Last modified: 2026.10.17
+ *
+ *  Function:
+ *      performance counters for the algorithms
+ *      hardware events by perf_event_open: cycles, instructions, L1 data cache misses,
+ *      last level cache misses and branch mispredicts
+ *      algorithm events counted by PERF_COUNT: comparisons, swaps, moves, heap operations
+ *      and edge relaxations
+ *      compile with -DALGO_PERF to enable them, otherwise PERF_COUNT expands to nothing
+ *      and measure() only times the call
+ */
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <iostream>
+
+#if defined(ALGO_PERF) && defined(__linux__)
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#define ALGO_PERF_HARDWARE
+#endif
+
+namespace perf {
+
+enum Event {
+    COMPARISONS, SWAPS, MOVES, HEAP_OPS, RELAXATIONS, EVENT_KINDS
+};
+
+const char *const EVENT_NAMES[EVENT_KINDS] = {"comparisons", "swaps", "moves", "heap_ops", "relaxations"};
+
+enum Hardware {
+    CYCLES, INSTRUCTIONS, L1D_MISSES, LLC_MISSES, BRANCH_MISSES, HARDWARE_KINDS
+};
+
+const char *const HARDWARE_NAMES[HARDWARE_KINDS] = {"cycles", "instructions", "l1d_misses", "llc_misses",
+                                                    "branch_misses"};
+
+#ifdef ALGO_PERF
+struct ThreadEvents;
+
+/**
+ * all threads' event counters, and the sums of the threads that exited
+ *  never destroyed, the task pool threads may exit after the static objects
+ */
+struct EventRegistry {
+    std::mutex mtx;
+    std::vector<ThreadEvents *> threads;
+    uint64_t retired[EVENT_KINDS] = {};
+};
+
+inline EventRegistry &event_registry() {
+    static EventRegistry *registry = new EventRegistry;
+    return *registry;
+}
+
+/**
+ * event counters of one thread, only the owner writes them, by a plain load and store,
+ * so counting costs no locked instruction and no shared cache line
+ *  they are atomic only so measure() can read them from another thread
+ */
+struct ThreadEvents {
+    std::atomic<uint64_t> counts[EVENT_KINDS];
+
+    ThreadEvents() {
+        for (auto &c: counts)
+            c.store(0, std::memory_order_relaxed);
+        EventRegistry &registry = event_registry();
+        std::lock_guard<std::mutex> lk(registry.mtx);
+        registry.threads.push_back(this);
+    }
+
+    ~ThreadEvents() {
+        EventRegistry &registry = event_registry();
+        std::lock_guard<std::mutex> lk(registry.mtx);
+        for (int i = 0; i != EVENT_KINDS; ++i)
+            registry.retired[i] += counts[i].load(std::memory_order_relaxed);
+        registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), this));
+    }
+};
+
+inline void add_event(Event event, uint64_t n) {
+    thread_local ThreadEvents events;
+    auto &c = events.counts[event];
+    c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+/**
+ * total count of an event over all threads, alive or exited
+ */
+inline uint64_t event_total(Event event) {
+    EventRegistry &registry = event_registry();
+    std::lock_guard<std::mutex> lk(registry.mtx);
+    uint64_t total = registry.retired[event];
+    for (auto t: registry.threads)
+        total += t->counts[event].load(std::memory_order_relaxed);
+    return total;
+}
+
+#define PERF_ADD(event, n) (perf::add_event(perf::event, (n)))
+#else
+#define PERF_ADD(event, n) ((void)0)
+#endif
+#define PERF_COUNT(event) PERF_ADD(event, 1)
+
+/**
+ * hardware counters of the calling thread and the threads it creates during the
+ * measurement, threads created before(e.g. a task pool) are not counted
+ *  every event has its own counter, when the pmu multiplexes them the values are
+ *  scaled by time_enabled / time_running
+ *  a counter is unavailable if perf_event_open fails, e.g. in containers or when
+ *  /proc/sys/kernel/perf_event_paranoid forbids it
+ */
+class HardwareCounters {
+public:
+    HardwareCounters() {
+        for (auto &fd: fds)
+            fd = -1;
+#ifdef ALGO_PERF_HARDWARE
+        const uint32_t types[HARDWARE_KINDS] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+                                                PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE};
+        const uint64_t configs[HARDWARE_KINDS] = {
+                PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                PERF_COUNT_HW_CACHE_L1D | PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16,
+                PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+        for (int i = 0; i != HARDWARE_KINDS; ++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = types[i];
+            attr.config = configs[i];
+            attr.disabled = 1;
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds[i] = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+#endif
+    }
+
+    HardwareCounters(const HardwareCounters &) = delete;
+
+    HardwareCounters &operator=(const HardwareCounters &) = delete;
+
+    ~HardwareCounters() {
+#ifdef ALGO_PERF_HARDWARE
+        for (auto fd: fds)
+            if (fd >= 0)
+                close(fd);
+#endif
+    }
+
+    void start() {
+#ifdef ALGO_PERF_HARDWARE
+        for (auto fd: fds)
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+    }
+
+    void stop() {
+#ifdef ALGO_PERF_HARDWARE
+        for (auto fd: fds)
+            if (fd >= 0)
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+#endif
+    }
+
+    /**
+     * read the value of a counter
+     * @param kind: the hardware event
+     * @param value: save the scaled value
+     * return: false if the counter is unavailable
+     */
+    bool read(Hardware kind, uint64_t &value) const {
+#ifdef ALGO_PERF_HARDWARE
+        uint64_t data[3]; //value, time enabled, time running
+        if (fds[kind] < 0 || ::read(fds[kind], data, sizeof(data)) != sizeof(data) || data[2] == 0)
+            return false;
+        value = data[1] == data[2] ? data[0]
+                                   : static_cast<uint64_t>(static_cast<double>(data[0]) * data[1] / data[2]);
+        return true;
+#else
+        (void) kind;
+        (void) value;
+        return false;
+#endif
+    }
+
+private:
+    int fds[HARDWARE_KINDS];
+};
+
+/**
+ * report of one measured call
+ */
+struct Report {
+    std::string name;
+    double seconds = 0;
+    bool available[HARDWARE_KINDS] = {}; //whether the hardware event was counted
+    uint64_t hardware[HARDWARE_KINDS] = {};
+    uint64_t events[EVENT_KINDS] = {};
+
+    /**
+     * print the report in one line: name, time, hardware events, ipc and algorithm events
+     * @param out: output stream
+     * return: none
+     */
+    void print(std::ostream &out = std::cerr) const {
+        out << name << ": " << seconds * 1000 << " ms";
+#ifdef ALGO_PERF
+        for (int i = 0; i != HARDWARE_KINDS; ++i) {
+            out << ", " << HARDWARE_NAMES[i] << " ";
+            if (available[i])
+                out << hardware[i];
+            else
+                out << "n/a";
+        }
+        if (available[CYCLES] && available[INSTRUCTIONS] && hardware[CYCLES])
+            out << ", ipc " << static_cast<double>(hardware[INSTRUCTIONS]) / hardware[CYCLES];
+        for (int i = 0; i != EVENT_KINDS; ++i)
+            out << ", " << EVENT_NAMES[i] << " " << events[i];
+#endif
+        out << std::endl;
+    }
+};
+
+/**
+ * measure one call of f(args...)
+ *  algorithm events are the difference of the counters before and after the call,
+ *  so calls measured in other threads at the same time are mixed in
+ *  e.g. measure("quick_sort", quick_sort, arr).print()
+ * @param name: name of the call in the report
+ * @param f: function, e.g. a TF sort function or a graph routine
+ * @param args: arguments of f
+ * return: report of the call
+ */
+template<typename F, typename... Args>
+Report measure(const std::string &name, F &&f, Args &&... args) {
+    Report report;
+    report.name = name;
+#ifdef ALGO_PERF
+    uint64_t before[EVENT_KINDS];
+    for (int i = 0; i != EVENT_KINDS; ++i)
+        before[i] = event_total(static_cast<Event>(i));
+#endif
+    HardwareCounters counters;
+
+    auto start = std::chrono::steady_clock::now();
+    counters.start();
+    std::forward<F>(f)(std::forward<Args>(args)...);
+    counters.stop();
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (int i = 0; i != HARDWARE_KINDS; ++i)
+        report.available[i] = counters.read(static_cast<Hardware>(i), report.hardware[i]);
+#ifdef ALGO_PERF
+    for (int i = 0; i != EVENT_KINDS; ++i)
+        report.events[i] = event_total(static_cast<Event>(i)) - before[i];
+#endif
+    return report;
+}
+
+}
+
+#endif //ALGORITHMS_PERF_COUNTER_H
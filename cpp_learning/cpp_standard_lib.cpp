@@ -38,6 +38,7 @@
 #include <memory>
 
 #include "StrBlob.h"
+#include "../sort/sort.h"
 
 using namespace std;
 using namespace std::placeholders;
@@ -142,19 +143,18 @@ void print_seq(const T &seq, const char *sep = " ", const string &end = "\n") {
 
 /**
  * example for generic algorithms
+ *  sort and unique in one pass, strings are compared by cached 8-byte chunks instead of prefixes again and again
  * @param words: vector of words
  * @param sz: threshold for length of string
  */
 void elim_dups(vector<string> &words){
-    sort(words.begin(), words.end());
-    auto end_unique = unique(words.begin(), words.end());
-    words.erase(end_unique, words.end());
+    algo::string_sort(words, true);
 }
 
 void biggies(vector<string> &words, vector<string>::size_type sz) {
     elim_dups(words);
-    auto isshorter = [](const string &a, const string &b) { return a.size() < b.size(); };
-    stable_sort(words.begin(), words.end(), isshorter);
+    auto length = [](const string &s) { return s.size(); };
+    algo::radix_sort(words.begin(), words.end(), length); //stable, like stable_sort by isshorter
     auto wc = find_if(words.begin(), words.end(), [sz](const string &s) { return s.size() >= sz; });
     auto cnt = words.end() - wc;
     cout << cnt << " word" << (cnt > 1 ? "s" : "") << " of length " << sz << " or longer" << endl;
@@ -0,0 +1,187 @@
+#ifndef ALGORITHMS_CSR_GRAPH_H
+#define ALGORITHMS_CSR_GRAPH_H
+
+/*
+ *  Copyright(c) 2018 Gang Zhang
+ *  All rights reserved.
+ *  Author: Gang Zhang
+ *  Creation date: 2026.10.17
+ *  Last modified: 2026.10.17
+ *
+ *  Function:
+ *      graph saved in compressed sparse row format, shared by all graph programs
+ *      out-edges of vertex u are targets[offsets[u], offsets[u + 1]), with optional weights
+ *      in the same positions, the reversed graph(compressed sparse column) is built on demand
+ *      the arrays are owned by the graph or by a mapped file(see graph_io.h), copies share them
+ */
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+/**
+ * read-only range of neighbors or weights of a vertex
+ */
+template<typename T>
+struct CSRRange {
+    const T *first, *last;
+
+    const T *begin() const { return first; }
+
+    const T *end() const { return last; }
+
+    size_t size() const { return last - first; }
+
+    const T &operator[](size_t i) const { return first[i]; }
+};
+
+/**
+ * compressed sparse row graph:
+ *  two arrays instead of one vector per vertex, neighbors of a vertex are contiguous and
+ *  vertices are stored one after another, so a scan never chases pointers
+ *  space complexity: 8*(|V|+1) + 4*|E| bytes, 4*|E| more bytes for the weights
+ *  the graph is immutable, copying it only copies the pointers
+ */
+class CSRGraph {
+public:
+    using vertex_t = uint32_t;
+    using edge_t = uint64_t;
+    using weight_t = int32_t;
+
+    CSRGraph() : CSRGraph(0, 0) {}
+
+    /**
+     * view arrays owned by someone else, e.g. a mapped file
+     * @param owner: keeps the arrays alive as long as any copy of the graph
+     * @param num: number of vertices
+     * @param edges: number of edges
+     * @param offsets: num + 1 offsets, offsets[0] = 0 and offsets[num] = edges
+     * @param targets: target vertices of the edges
+     * @param weights: weights of the edges, nullptr for an unweighted graph
+     * return: the graph
+     */
+    static CSRGraph view(std::shared_ptr<const void> owner, size_t num, size_t edges, const edge_t *offsets,
+                         const vertex_t *targets, const weight_t *weights) {
+        CSRGraph graph;
+        graph.storage.reset();
+        graph.owner = std::move(owner);
+        graph.n = num;
+        graph.m = edges;
+        graph.offs = offsets;
+        graph.tgts = targets;
+        graph.wts = weights;
+        return graph;
+    }
+
+    /**
+     * build the graph from an edge list by counting sort on the source vertices
+     *  out-edges of every vertex keep the order of the edge list
+     *  time complexity: O(|V|+|E|)
+     * @param num: number of vertices
+     * @param edges: directed edges (u, v)
+     * @param weights: weights of the edges, empty for an unweighted graph
+     * return: the graph
+     */
+    static CSRGraph from_edges(size_t num, const std::vector<std::pair<vertex_t, vertex_t>> &edges,
+                               const std::vector<weight_t> &weights = std::vector<weight_t>()) {
+        CSRGraph graph(num, edges.size(), !weights.empty());
+        Storage &data = *graph.storage;
+        for (const auto &e: edges)
+            data.offs[e.first + 1]++;
+        for (size_t u = 0; u != num; ++u)
+            data.offs[u + 1] += data.offs[u];
+
+        std::vector<edge_t> pos(data.offs.begin(), data.offs.end() - 1);
+        for (size_t i = 0; i != edges.size(); ++i) {
+            edge_t p = pos[edges[i].first]++;
+            data.tgts[p] = edges[i].second;
+            if (!weights.empty())
+                data.wts[p] = weights[i];
+        }
+        return graph;
+    }
+
+    /**
+     * the reversed graph, in-edges of the original graph in compressed sparse column format
+     *  in-edges of every vertex are ordered by their source vertices
+     *  time complexity: O(|V|+|E|)
+     */
+    CSRGraph transpose() const {
+        CSRGraph graph(n, m, weighted());
+        Storage &data = *graph.storage;
+        for (size_t e = 0; e != m; ++e)
+            data.offs[tgts[e] + 1]++;
+        for (size_t u = 0; u != n; ++u)
+            data.offs[u + 1] += data.offs[u];
+
+        std::vector<edge_t> pos(data.offs.begin(), data.offs.end() - 1);
+        for (vertex_t u = 0; u != n; ++u)
+            for (edge_t e = offs[u]; e != offs[u + 1]; ++e) {
+                edge_t p = pos[tgts[e]]++;
+                data.tgts[p] = u;
+                if (wts)
+                    data.wts[p] = wts[e];
+            }
+        return graph;
+    }
+
+    size_t num_vertices() const { return n; }
+
+    size_t num_edges() const { return m; }
+
+    bool weighted() const { return wts != nullptr; }
+
+    size_t degree(vertex_t u) const { return offs[u + 1] - offs[u]; }
+
+    CSRRange<vertex_t> neighbors(vertex_t u) const {
+        return {tgts + offs[u], tgts + offs[u + 1]};
+    }
+
+    /**
+     * weights of the out-edges of u, in the order of neighbors(u)
+     */
+    CSRRange<weight_t> weights(vertex_t u) const {
+        return {wts + offs[u], wts + offs[u + 1]};
+    }
+
+    CSRRange<edge_t> offsets() const { return {offs, offs + n + 1}; }
+
+    CSRRange<vertex_t> targets() const { return {tgts, tgts + m}; }
+
+    /**
+     * weights of all edges, empty if unweighted
+     */
+    CSRRange<weight_t> edge_weights() const { return {wts, wts ? wts + m : wts}; }
+
+private:
+    struct Storage {
+        std::vector<edge_t> offs;
+        std::vector<vertex_t> tgts;
+        std::vector<weight_t> wts;
+    };
+
+    /**
+     * graph owning zeroed arrays of num vertices and edges edges
+     */
+    CSRGraph(size_t num, size_t edges, bool has_weights = false)
+            : storage(std::make_shared<Storage>()), n(num), m(edges) {
+        storage->offs.assign(num + 1, 0);
+        storage->tgts.resize(edges);
+        if (has_weights)
+            storage->wts.resize(edges);
+        owner = storage;
+        offs = storage->offs.data();
+        tgts = storage->tgts.data();
+        wts = has_weights ? storage->wts.data() : nullptr;
+    }
+
+    std::shared_ptr<Storage> storage;   //arrays owned by the graph, null for a view
+    std::shared_ptr<const void> owner;  //keeps the arrays alive
+    size_t n, m;                        //number of vertices and edges
+    const edge_t *offs;                 //out-edges of u are [offs[u], offs[u + 1])
+    const vertex_t *tgts;               //target vertex of every edge
+    const weight_t *wts;                //weight of every edge, nullptr if unweighted
+};
+
+#endif //ALGORITHMS_CSR_GRAPH_H
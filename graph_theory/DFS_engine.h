@@ -0,0 +1,135 @@
+#ifndef ALGORITHMS_DFS_ENGINE_H
+#define ALGORITHMS_DFS_ENGINE_H
+
+/*
+ *  Copyright(c) 2018 Gang Zhang
+ *  All rights reserved.
+ *  Author: Gang Zhang
+ *  Creation date: 2026.10.17
+ *  Last modified: 2026.10.17
+ *
+ *  Function:
+ *      iterative DFS on CSR graphs, reporting events to a visitor
+ *      every frame of the stack keeps the next out-edge of its vertex, so every edge is
+ *      checked once and the depth is only limited by the memory
+ */
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "CSR_graph.h"
+
+/**
+ * visitor with empty hooks, derive from it and define the hooks to use
+ *  discover(u): u is visited the first time
+ *  finish(u): all out-edges of u are checked, u leaves the stack
+ *  tree_edge(u, v): v is discovered by the edge (u, v)
+ *  back_edge(u, v): v is on the stack, the edge closes a cycle
+ *  forward_or_cross_edge(u, v): v is already finished
+ */
+struct DFSVisitor {
+    void discover(CSRGraph::vertex_t) {}
+
+    void finish(CSRGraph::vertex_t) {}
+
+    void tree_edge(CSRGraph::vertex_t, CSRGraph::vertex_t) {}
+
+    void back_edge(CSRGraph::vertex_t, CSRGraph::vertex_t) {}
+
+    void forward_or_cross_edge(CSRGraph::vertex_t, CSRGraph::vertex_t) {}
+};
+
+/**
+ * DFS engine:
+ *  a stack of (vertex, next edge) cursors instead of recursion, a vertex on the top goes on
+ *  from its cursor, never from its first edge again
+ *  visited and finished states are two bitmaps, 2 bits per vertex, and are kept between
+ *  runs, so a forest is searched by calling run() for every root
+ * Time complexity: O(|V|+|E|)
+ * Space complexity: O(|V|/4) bytes for the bitmaps, 16 bytes per frame of the stack(padded)
+ */
+class DFSEngine {
+public:
+    using vertex_t = CSRGraph::vertex_t;
+    using edge_t = CSRGraph::edge_t;
+
+    explicit DFSEngine(const CSRGraph &graph)
+            : graph(graph), visited_bits((graph.num_vertices() + 63) / 64, 0),
+              finished_bits((graph.num_vertices() + 63) / 64, 0) {}
+
+    bool visited(vertex_t u) const { return visited_bits[u >> 6] >> (u & 63) & 1; }
+
+    bool finished(vertex_t u) const { return finished_bits[u >> 6] >> (u & 63) & 1; }
+
+    /**
+     * forget all visited vertices
+     */
+    void reset() {
+        std::fill(visited_bits.begin(), visited_bits.end(), 0);
+        std::fill(finished_bits.begin(), finished_bits.end(), 0);
+    }
+
+    /**
+     * DFS from src, vertices visited by former runs are not visited again
+     * @param src: root of the DFS tree
+     * @param visitor: receives the events
+     * return: none
+     */
+    template<typename Visitor>
+    void run(vertex_t src, Visitor &visitor) {
+        if (visited(src)) return;
+        auto offsets = graph.offsets();
+        auto targets = graph.targets();
+
+        mark(visited_bits, src);
+        visitor.discover(src);
+        stack.push_back({src, offsets[src]});
+        while (!stack.empty()) {
+            vertex_t u = stack.back().u;
+            edge_t e = stack.back().next++;
+            if (e == offsets[u + 1]) {
+                stack.pop_back();
+                mark(finished_bits, u);
+                visitor.finish(u);
+                continue;
+            }
+
+            vertex_t v = targets[e];
+            if (!visited(v)) {
+                visitor.tree_edge(u, v);
+                mark(visited_bits, v);
+                visitor.discover(v);
+                stack.push_back({v, offsets[v]});
+            } else if (!finished(v))
+                visitor.back_edge(u, v);
+            else
+                visitor.forward_or_cross_edge(u, v);
+        }
+    }
+
+    /**
+     * DFS from every unvisited vertex in order of the vertex ids
+     * @param visitor: receives the events
+     * return: none
+     */
+    template<typename Visitor>
+    void run_all(Visitor &visitor) {
+        for (vertex_t u = 0; u != graph.num_vertices(); ++u)
+            run(u, visitor);
+    }
+
+private:
+    struct Frame {
+        vertex_t u;
+        edge_t next; //the next out-edge to check
+    };
+
+    static void mark(std::vector<uint64_t> &bits, vertex_t u) { bits[u >> 6] |= uint64_t(1) << (u & 63); }
+
+    const CSRGraph &graph;
+    std::vector<uint64_t> visited_bits, finished_bits;
+    std::vector<Frame> stack;
+};
+
+#endif //ALGORITHMS_DFS_ENGINE_H
@@ -28,34 +28,43 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include <cstdint>
+
+#include "CSR_graph.h"
+#include "graph_io.h"
+
 using namespace std;
-using GraphList = vector<vector<int>>;
 
 /**
  * loop method to get Euler path of the undirected graph
+ *  every vertex keeps a cursor to its first out-edge which may be unvisited, edges before
+ *  the cursor are never checked again
  * Time complexity: O(|E|)
- * @param graph: adjacent list of the undirected graph
+ * @param graph: CSR graph of the undirected graph, every edge is saved in both directions
+ *               and the weight of both is the id of the edge in [0, |E|/2)
  * @param src: source vertex of the graph
  * @return: Euler path
  */
-vector<int> loop_method(GraphList &graph, int src=0){
-    size_t size = graph.size();
+vector<int> loop_method(const CSRGraph &graph, int src=0){
+    const auto &offsets = graph.offsets();
+    const auto &targets = graph.targets();
+    const auto &ids = graph.edge_weights();
 
     stack<int> s;
     vector<int> seq;
-    vector<vector<int>> visited(size, vector<int>(size, false)); //mark whether the edges are visited
+    vector<bool> visited(graph.num_edges() / 2, false); //mark whether the edges are visited
+    vector<CSRGraph::edge_t> cursor(offsets.begin(), offsets.end() - 1);
 
     s.push(src);
     while(!s.empty())
     {
         int u = s.top();
         bool flag = false;
-        for(const auto &v: graph[u])
-            if(!visited[u][v])
+        for(auto &e = cursor[u]; e != offsets[u + 1]; ++e)
+            if(!visited[ids[e]])
             {
-                visited[u][v] = true;
-                visited[v][u] = true;
-                s.push(v);
+                visited[ids[e]] = true;
+                s.push(targets[e]);
                 flag = true;
                 break;
             }
@@ -68,17 +77,70 @@ vector<int> loop_method(GraphList &graph, int src=0){
     return seq;
 }
 
-int main(){
-    size_t num;
-    cout << "请输入顶点数:"; cin >> num;
-    GraphList graph(num);
+/**
+ * check the graph is an undirected graph for loop_method: weighted, every id in [0, |E|/2)
+ * is the weight of exactly two edges, (u, v) and (v, u)
+ * Time complexity: O(|V|+|E|)
+ * @param graph: CSR graph
+ * @return: true if loop_method can use the weights as edge ids
+ */
+bool valid_undirected(const CSRGraph &graph){
+    size_t half = graph.num_edges() / 2;
+    if(graph.num_edges() == 0)
+        return true;
+    if(!graph.weighted() || graph.num_edges() % 2 != 0)
+        return false;
 
-    cout << "请依次输入有向图的边,以0 0结束:" << endl;
-    int u, v;
-    while (cin >> u >> v && !(u == 0 && v == 0))
+    const CSRGraph::vertex_t NONE = UINT32_MAX;
+    vector<CSRGraph::vertex_t> first_u(half, NONE), first_v(half);
+    vector<bool> matched(half, false);
+    for(CSRGraph::vertex_t u = 0; u != graph.num_vertices(); ++u)
     {
-        graph[u].push_back(v);
-        graph[v].push_back(u);
+        auto neighbors = graph.neighbors(u);
+        auto ids = graph.weights(u);
+        for(size_t k = 0; k != neighbors.size(); ++k)
+        {
+            if(ids[k] < 0 || static_cast<size_t>(ids[k]) >= half || matched[ids[k]])
+                return false;
+            if(first_u[ids[k]] == NONE)
+            {
+                first_u[ids[k]] = u;
+                first_v[ids[k]] = neighbors[k];
+            }
+            else if(first_u[ids[k]] == neighbors[k] && first_v[ids[k]] == u)
+                matched[ids[k]] = true;
+            else
+                return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * usage: Euler_path [graph.bin], read the graph from cin without the binary graph file
+ *  the binary graph file should be converted by graph_convert --undirected
+ */
+int main(int argc, char *argv[]){
+    CSRGraph graph;
+    if (argc > 1) {
+        if (!load_graph(argv[1], graph)) {
+            cerr << "can't load graph file " << argv[1] << endl;
+            return 1;
+        }
+    } else {
+        size_t num;
+        cout << "请输入顶点数:"; cin >> num;
+        cout << "请输入边数,再依次输入无向图的边:" << endl;
+        if (!read_graph(cin, num, graph, false, true)) {
+            cerr << "invalid edge list." << endl;
+            return 1;
+        }
+    }
+    if (graph.num_vertices() == 0)
+        return 0;
+    if (!valid_undirected(graph)) {
+        cerr << "the graph is not undirected with edge ids, convert it by graph_convert --undirected." << endl;
+        return 1;
     }
 
     auto seq = loop_method(graph, 0);
@@ -91,6 +153,7 @@ int main(){
 
 /*
  9
+ 11
  0 7
  0 8
  1 2
@@ -102,5 +165,4 @@ int main(){
  5 6
  6 7
  6 8
- 0 0
  */
\ No newline at end of file
@@ -6,7 +6,8 @@
  *  Last modified: 2018.4.2
  *
  *  Function:
- *      to get the strong connected components of directed graph
+ *      to get the strong connected components of directed graph, the condensation dag and
+ *      a reachability index over it
  */
 
 #include <iostream>
@@ -28,41 +29,32 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include "CSR_graph.h"
+#include "graph_io.h"
+#include "DFS_engine.h"
+#include "worker_group.h"
+
 using namespace std;
 
-using GraphList = vector<vector<int>>;
 using TArray = vector<vector<int>>;
 
 /**
- * DFS for graph using stack
- * @param graph: adjacent list of graph
- * @param visited: mark whether vertices are visited
- * @param topo_seq: reversed topological sequence
- * @param src: start vertex for DFS
+ * visitor saving the vertices in finish order
  */
-void DFS(const GraphList &graph, vector<bool> &visited, vector<int> &topo_seq, int src){
-    stack<int> s;
-    s.push(src);
-    visited[src] = true;
-    while(!s.empty())
-    {
-        int u = s.top();
-        bool flag = false;
-        for(const auto &v: graph[u])
-            if(!visited[v])
-            {
-                s.push(v);
-                visited[v] = true;
-                flag = true;
-                break;
-            }
-        if(!flag)
-        {
-            s.pop();
-            topo_seq.push_back(u);
-        }
-    }
-}
+struct FinishVisitor : DFSVisitor {
+    vector<int> &seq;
+
+    explicit FinishVisitor(vector<int> &seq) : seq(seq) {}
+
+    void finish(CSRGraph::vertex_t u) { seq.push_back(u); }
+};
 
 /**
  * Kosarju Algorithm:
@@ -71,41 +63,770 @@ void DFS(const GraphList &graph, vector<bool> &visited, vector<int> &topo_seq, i
  * Time complexity:
  *   O(|V|+|E|)
  * @param graph: original directed graph
- * @param rgraph: reversed directed graph
+ * @param rgraph: reversed directed graph, graph.transpose()
  * @return: all SCC
  */
-TArray Kosaraju(const GraphList &graph, const GraphList &rgraph){
-    size_t size = graph.size();
+TArray Kosaraju(const CSRGraph &graph, const CSRGraph &rgraph){
+    size_t size = graph.num_vertices();
     vector<int> topo_seq;
-    vector<bool> visited(size, false);
-    for(int i=0; i != size; ++i)
-        if(!visited[i])
-            DFS(graph, visited, topo_seq, i);
+    FinishVisitor topo(topo_seq);
+    DFSEngine(graph).run_all(topo);
 
     TArray components;
-    visited = vector<bool>(size, false);
+    DFSEngine engine(rgraph);
     for(int i = size-1; i >= 0; --i)
-        if(!visited[topo_seq[i]])
+        if(!engine.visited(topo_seq[i]))
         {
             components.emplace_back();
-            DFS(rgraph, visited, components[components.size()-1], topo_seq[i]);
+            FinishVisitor component(components.back());
+            engine.run(topo_seq[i], component);
         }
     return components;
 }
 
-int main(){
-    size_t num;
-    cout << "请输入顶点数:"; cin >> num;
-    GraphList graph(num), rgraph(num);
+/**
+ * vertex-to-component labels
+ */
+struct SCCLabels {
+    vector<uint32_t> label; //component of every vertex
+    size_t count = 0;       //number of components
+};
+
+/**
+ * Pearce Algorithm(iterative Tarjan with one index array):
+ *   rindex[v] is the DFS index of v while v is open, lowered to the smallest index reachable
+ *   from v like the low-link of Tarjan, v is the root of a component if it keeps its own index
+ *   closed vertices get rindex = n-1-component, not smaller than any open index, so edges into
+ *   finished components are ignored without an on-stack flag
+ *   only the forward graph is used, the call stack keeps (vertex, edge) cursors
+ * Time complexity:
+ *   O(|V|+|E|), every edge is checked once
+ * Space complexity:
+ *   4|V| bytes of rindex, |V|/8 bytes of root flags, the vertex stack and the call stack
+ * @param graph: directed graph
+ * @return: labels in reversed topological order, component 0 is a sink of the condensation
+ */
+SCCLabels Pearce(const CSRGraph &graph){
+    using vertex_t = CSRGraph::vertex_t;
+    using edge_t = CSRGraph::edge_t;
+    struct Frame {
+        vertex_t v;
+        edge_t next; //the out-edge being checked
+    };
+
+    SCCLabels res;
+    size_t size = graph.num_vertices();
+    if(size == 0)
+        return res;
+    auto offsets = graph.offsets();
+    auto targets = graph.targets();
+    vector<uint32_t> rindex(size, 0);
+    vector<uint64_t> root((size + 63) / 64, 0);
+    auto is_root = [&root](vertex_t v) { return root[v >> 6] >> (v & 63) & 1; };
+    auto set_root = [&root](vertex_t v, bool flag) {
+        root[v >> 6] = (root[v >> 6] & ~(uint64_t(1) << (v & 63))) | uint64_t(flag) << (v & 63);
+    };
 
-    int u, v;
-    cout << "请依次输入有向图的边,以0 0结束:" << endl;
-    while (cin >> u >> v&& !(u == 0 && v == 0))
+    uint32_t index = 1;
+    vector<vertex_t> vstack;
+    vector<Frame> call;
+    auto visit = [&](vertex_t v) {
+        rindex[v] = index++;
+        set_root(v, true);
+        call.push_back({v, offsets[v]});
+    };
+    for(vertex_t s = 0; s != size; ++s)
     {
-        graph[u].push_back(v);
-        rgraph[v].push_back(u);
+        if(rindex[s])
+            continue;
+        visit(s);
+        while(!call.empty())
+        {
+            Frame &f = call.back();
+            vertex_t v = f.v;
+            if(f.next != offsets[v + 1])
+            {
+                vertex_t w = targets[f.next];
+                if(!rindex[w])
+                {
+                    visit(w); //the edge is checked again when w is finished
+                    continue;
+                }
+                if(rindex[w] < rindex[v])
+                {
+                    rindex[v] = rindex[w];
+                    set_root(v, false);
+                }
+                ++f.next;
+                continue;
+            }
+
+            //v is finished
+            call.pop_back();
+            if(is_root(v))
+            {
+                uint32_t c = size - 1 - res.count++;
+                --index;
+                while(!vstack.empty() && rindex[v] <= rindex[vstack.back()])
+                {
+                    rindex[vstack.back()] = c;
+                    vstack.pop_back();
+                    --index;
+                }
+                rindex[v] = c;
+            }
+            else
+                vstack.push_back(v);
+        }
     }
 
+    res.label.swap(rindex);
+    for(auto &l: res.label)
+        l = size - 1 - l;
+    return res;
+}
+
+/**
+ * renumber the components by their smallest vertices, so labels of the same partition are
+ * equal whichever algorithm computed them
+ * @param label: component of every vertex, any ids less than the number of vertices
+ * @return: labels, component i has the i-th smallest minimal vertex
+ */
+SCCLabels canonical_labels(const vector<uint32_t> &label){
+    SCCLabels res;
+    vector<uint32_t> id(label.size(), UINT32_MAX);
+    res.label.resize(label.size());
+    for(size_t v = 0; v != label.size(); ++v)
+    {
+        if(id[label[v]] == UINT32_MAX)
+            id[label[v]] = res.count++;
+        res.label[v] = id[label[v]];
+    }
+    return res;
+}
+
+/**
+ * labels of the components given as vertex lists, e.g. by Kosaraju
+ * @param components: all SCC
+ * @param size: number of vertices
+ * @return: canonical labels
+ */
+SCCLabels canonical_labels(const TArray &components, size_t size){
+    vector<uint32_t> label(size);
+    for(size_t i = 0; i != components.size(); ++i)
+        for(auto v: components[i])
+            label[v] = i;
+    return canonical_labels(label);
+}
+
+const size_t SCC_CHUNK = 1024;        //vertices per chunk taken by a thread
+const size_t SCC_COLOR_ROUNDS = 64;   //propagation rounds of a coloring before giving up
+const size_t SCC_SERIAL = 1 << 12;    //fewer remaining vertices are left to Pearce
+const uint32_t SCC_NONE = UINT32_MAX; //label of a vertex not in any component yet
+
+/**
+ * parallel SCC(trim, forward-backward and coloring, Hong et al. and Orzan):
+ *   every remaining vertex belongs to a part, no SCC crosses two parts, so edges between
+ *   parts are ignored
+ *   1.trim: vertices without in-edges or out-edges in their part are SCC by themselves,
+ *     removed level by level with atomic degree counters
+ *   2.forward-backward: the vertices both reached from and reaching a pivot of large degrees
+ *     by parallel BFS are the giant SCC, the forward rest, the backward rest and the others
+ *     become three parts
+ *   3.coloring: the largest vertex id reaching every vertex is propagated in parallel, a vertex
+ *     keeping its own id is a root, its SCC is the backward reach among its color, roots are
+ *     searched in parallel, every color becomes a part
+ *   trim and coloring repeat until few vertices remain or the colors don't settle in
+ *   SCC_COLOR_ROUNDS rounds(e.g. long chains of cycles), the rest goes to Pearce
+ *   all phases run on one group of threads kept for the whole call, levels and sets of a few
+ *   chunks are done by the caller alone, so a high-diameter SCC costs no thread wake-ups
+ * Time complexity:
+ *   O((|V|+|E|) * rounds) / threads
+ * @param graph: directed graph
+ * @param rgraph: reversed graph, graph.transpose()
+ * @param threads: number of threads, 0 for all cores
+ * @return: canonical labels, the same as canonical_labels(Kosaraju(graph, rgraph), n)
+ */
+SCCLabels parallel_SCC(const CSRGraph &graph, const CSRGraph &rgraph, size_t threads = 0){
+    using vertex_t = CSRGraph::vertex_t;
+    WorkerGroup group(threads);
+    threads = group.size();
+    size_t size = graph.num_vertices();
+    vector<uint32_t> label(size, SCC_NONE), part(size, 0);
+    vector<atomic<uint8_t>> mark(size);
+    vector<atomic<uint32_t>> count_in(size), count_out(size);
+    vector<vertex_t> active(size);
+    for(size_t v = 0; v != size; ++v)
+    {
+        mark[v].store(0, memory_order_relaxed);
+        active[v] = v;
+    }
+    vector<vector<vertex_t>> buffers(threads);
+    auto live = [&](vertex_t w, vertex_t v) { return label[w] == SCC_NONE && part[w] == part[v]; };
+    auto gather = [&](vector<vertex_t> &out) {
+        out.clear();
+        for(auto &buffer: buffers)
+        {
+            out.insert(out.end(), buffer.begin(), buffer.end());
+            buffer.clear();
+        }
+    };
+    auto remove_labeled = [&]() {
+        active.erase(remove_if(active.begin(), active.end(),
+                               [&](vertex_t v) { return label[v] != SCC_NONE; }), active.end());
+    };
+
+    //1.trim, labels are only written between levels, so live() is stable during a level
+    auto trim = [&]() {
+        vector<vertex_t> frontier;
+        group.for_chunks(active.size(), SCC_CHUNK, [&](size_t tid, size_t begin, size_t end) {
+            for(size_t i = begin; i != end; ++i)
+            {
+                vertex_t v = active[i];
+                uint32_t in = 0, out = 0;
+                for(auto w: rgraph.neighbors(v))
+                    in += w != v && live(w, v);
+                for(auto w: graph.neighbors(v))
+                    out += w != v && live(w, v);
+                count_in[v].store(in, memory_order_relaxed);
+                count_out[v].store(out, memory_order_relaxed);
+                if(in == 0 || out == 0)
+                {
+                    mark[v].store(1, memory_order_relaxed);
+                    buffers[tid].push_back(v);
+                }
+            }
+        });
+        gather(frontier);
+        while(!frontier.empty())
+        {
+            group.for_chunks(frontier.size(), SCC_CHUNK, [&](size_t tid, size_t begin, size_t end) {
+                auto release = [&](vertex_t w, atomic<uint32_t> &count) {
+                    if(count.fetch_sub(1, memory_order_relaxed) == 1 && !mark[w].exchange(1, memory_order_relaxed))
+                        buffers[tid].push_back(w);
+                };
+                for(size_t i = begin; i != end; ++i)
+                {
+                    vertex_t v = frontier[i];
+                    for(auto w: graph.neighbors(v))
+                        if(w != v && live(w, v))
+                            release(w, count_in[w]);
+                    for(auto w: rgraph.neighbors(v))
+                        if(w != v && live(w, v))
+                            release(w, count_out[w]);
+                }
+            });
+            for(auto v: frontier)
+                label[v] = v;
+            gather(frontier);
+        }
+        remove_labeled();
+        for(auto v: active)
+            mark[v].store(0, memory_order_relaxed);
+    };
+
+    //level synchronous parallel BFS inside the part of src, reached vertices get the bit
+    auto reach = [&](const CSRGraph &g, vertex_t src, uint8_t bit) {
+        vector<vertex_t> frontier{src};
+        mark[src].fetch_or(bit, memory_order_relaxed);
+        while(!frontier.empty())
+        {
+            group.for_chunks(frontier.size(), SCC_CHUNK, [&](size_t tid, size_t begin, size_t end) {
+                for(size_t i = begin; i != end; ++i)
+                    for(auto w: g.neighbors(frontier[i]))
+                        if(live(w, src) && !(mark[w].load(memory_order_relaxed) & bit)
+                           && !(mark[w].fetch_or(bit, memory_order_relaxed) & bit))
+                            buffers[tid].push_back(w);
+            });
+            gather(frontier);
+        }
+    };
+
+    //2.forward-backward from the vertex of the largest in-degree * out-degree
+    trim();
+    if(active.size() > SCC_SERIAL)
+    {
+        vertex_t pivot = *max_element(active.begin(), active.end(), [&](vertex_t a, vertex_t b) {
+            return graph.degree(a) * rgraph.degree(a) < graph.degree(b) * rgraph.degree(b);
+        });
+        reach(graph, pivot, 1);
+        reach(rgraph, pivot, 2);
+        for(auto v: active)
+        {
+            uint8_t m = mark[v].load(memory_order_relaxed);
+            if(m == 3)
+                label[v] = pivot;
+            else
+                part[v] = m;
+            mark[v].store(0, memory_order_relaxed);
+        }
+        remove_labeled();
+    }
+
+    //3.coloring
+    vector<atomic<uint32_t>> &color = count_in;
+    bool settled = true;
+    for(trim(); settled && active.size() > SCC_SERIAL; trim())
+    {
+        group.for_chunks(active.size(), SCC_CHUNK, [&](size_t, size_t begin, size_t end) {
+            for(size_t i = begin; i != end; ++i)
+                color[active[i]].store(active[i], memory_order_relaxed);
+        });
+        settled = false;
+        for(size_t round = 0; round != SCC_COLOR_ROUNDS && !settled; ++round)
+        {
+            atomic<bool> changed(false);
+            group.for_chunks(active.size(), SCC_CHUNK, [&](size_t, size_t begin, size_t end) {
+                bool local = false;
+                for(size_t i = begin; i != end; ++i)
+                {
+                    vertex_t v = active[i];
+                    uint32_t c = color[v].load(memory_order_relaxed);
+                    for(auto w: graph.neighbors(v))
+                        if(live(w, v))
+                        {
+                            uint32_t old = color[w].load(memory_order_relaxed);
+                            while(old < c && !color[w].compare_exchange_weak(old, c, memory_order_relaxed));
+                            local |= old < c;
+                        }
+                }
+                if(local)
+                    changed.store(true, memory_order_relaxed);
+            });
+            settled = !changed.load();
+        }
+        if(!settled)
+            break;
+
+        //colors are disjoint, so the backward searches of the roots never meet
+        vector<vertex_t> roots;
+        for(auto v: active)
+            if(color[v].load(memory_order_relaxed) == v)
+                roots.push_back(v);
+        group.for_chunks(roots.size(), SCC_CHUNK, [&](size_t, size_t begin, size_t end) {
+            vector<vertex_t> s;
+            for(size_t i = begin; i != end; ++i)
+            {
+                vertex_t r = roots[i];
+                label[r] = r;
+                s.push_back(r);
+                while(!s.empty())
+                {
+                    vertex_t v = s.back();
+                    s.pop_back();
+                    for(auto w: rgraph.neighbors(v))
+                        if(color[w].load(memory_order_relaxed) == r && live(w, r))
+                        {
+                            label[w] = r;
+                            s.push_back(w);
+                        }
+                }
+            }
+        });
+        remove_labeled();
+        for(auto v: active)
+            part[v] = color[v].load(memory_order_relaxed);
+    }
+
+    //the rest by Pearce on the subgraph induced by the remaining vertices
+    if(!active.empty())
+    {
+        vector<uint32_t> &id = part; //part is only needed for the edges
+        vector<pair<vertex_t, vertex_t>> edges;
+        for(size_t i = 0; i != active.size(); ++i)
+            for(auto w: graph.neighbors(active[i]))
+                if(live(w, active[i]))
+                    edges.emplace_back(i, w);
+        for(size_t i = 0; i != active.size(); ++i)
+            id[active[i]] = i;
+        for(auto &e: edges)
+            e.second = id[e.second];
+        SCCLabels sub = Pearce(CSRGraph::from_edges(active.size(), edges));
+        vector<uint32_t> rep(sub.count, SCC_NONE);
+        for(size_t i = 0; i != active.size(); ++i)
+        {
+            uint32_t &r = rep[sub.label[i]];
+            if(r == SCC_NONE)
+                r = active[i];
+            label[active[i]] = r;
+        }
+    }
+    return canonical_labels(label);
+}
+
+/**
+ * condensation of a directed graph, every SCC becomes one vertex
+ *  components are numbered in topological order, every edge of the dag goes from a smaller
+ *  component to a larger one
+ */
+struct Condensation {
+    vector<uint32_t> component; //component of every vertex
+    CSRGraph dag;               //edge (a, b) if an edge of the graph goes from a to b, no duplicates
+};
+
+/**
+ * build the condensation by Pearce, whose labels are a reversed topological order
+ * Time complexity:
+ *   O(|V|+|E|), duplicated edges are removed by marking the last source of every target
+ * @param graph: directed graph
+ * @return: the condensation
+ */
+Condensation condense(const CSRGraph &graph){
+    using vertex_t = CSRGraph::vertex_t;
+    size_t size = graph.num_vertices();
+    SCCLabels labels = Pearce(graph);
+    size_t count = labels.count;
+
+    Condensation res;
+    res.component.swap(labels.label);
+    vector<uint32_t> first(count + 1, 0), members(size);
+    for(auto &c: res.component)
+    {
+        c = count - 1 - c;
+        first[c + 1]++;
+    }
+    for(size_t c = 0; c != count; ++c)
+        first[c + 1] += first[c];
+    vector<uint32_t> pos(first.begin(), first.end() - 1);
+    for(size_t v = 0; v != size; ++v)
+        members[pos[res.component[v]]++] = v;
+
+    vector<pair<vertex_t, vertex_t>> edges;
+    vector<uint32_t> last(count, UINT32_MAX);
+    for(vertex_t a = 0; a != count; ++a)
+        for(size_t i = first[a]; i != first[a + 1]; ++i)
+            for(auto v: graph.neighbors(members[i]))
+            {
+                vertex_t b = res.component[v];
+                if(b != a && last[b] != a)
+                {
+                    last[b] = a;
+                    edges.emplace_back(a, b);
+                }
+            }
+    res.dag = CSRGraph::from_edges(count, edges);
+    return res;
+}
+
+const size_t REACH_MEMORY_CAP = size_t(1) << 30; //bytes of the transitive closure at most
+const size_t REACH_CHUNK_WORDS = 64;             //words of a row updated together
+const char REACH_FILE_MAGIC[8] = {'S', 'C', 'C', 'R', 'E', 'A', 'C', 'H'};
+const uint32_t REACH_FILE_VERSION = 1;
+const uint32_t REACH_FILE_CLOSURE = 1; //flag: the index is the transitive closure
+
+struct ReachFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t num_vertices;
+    uint64_t num_components;
+    uint64_t num_dag_edges;
+};
+
+/**
+ * reachability index over the condensation, "can u reach v?" without a traversal
+ *  closure mode: row a of the transitive closure as bitsets, as components are topologically
+ *      ordered the row only needs the bits of components >= a, so the closure is a triangle of
+ *      about C*C/16 bytes, it is built chunk by chunk of columns in reversed topological order,
+ *      so the rows of the successors are still in cache, every query is one bit
+ *  interval mode, when the closure exceeds the memory cap: one DFS on the dag gives
+ *      post[c]: postorder number
+ *      tree_low[c]: smallest post in the DFS subtree of c, [tree_low, post] contains exactly
+ *          the subtree, so containment proves reachability
+ *      low[c]: smallest post of all components reachable from c(GRAIL), b is only reachable
+ *          from a if [low[b], post[b]] is inside [low[a], post[a]]
+ *      queries decided by neither run a DFS pruned by both intervals and the topological order
+ *      queries are O(1) on average, as most are decided by the intervals alone, but the pruned
+ *      DFS is not bounded by them, a query is O(C+|E_dag|) in the worst case
+ *  the index is saved as a binary file: header, components, dag, then the closure or the
+ *  three interval arrays
+ */
+class ReachIndex {
+public:
+    using vertex_t = CSRGraph::vertex_t;
+
+    /**
+     * build the index of a graph
+     * Time complexity:
+     *   O(|V|+|E|) for the condensation and the intervals, O(C*|E_dag|/64) for the closure
+     * @param graph: directed graph
+     * @param memory_cap: bytes of the closure at most, otherwise the intervals are built
+     * @return: the index
+     */
+    static ReachIndex build(const CSRGraph &graph, size_t memory_cap = REACH_MEMORY_CAP) {
+        Condensation cond = condense(graph);
+        ReachIndex index;
+        index.component.swap(cond.component);
+        index.dag = cond.dag;
+        size_t count = index.dag.num_vertices();
+        if(row_offset(count, count) * sizeof(uint64_t) <= memory_cap)
+            index.build_closure();
+        else
+            index.build_intervals();
+        return index;
+    }
+
+    size_t num_components() const { return dag.num_vertices(); }
+
+    bool closure_mode() const { return !closure.empty() || num_components() == 0; }
+
+    /**
+     * topologically ordered component of vertex u
+     */
+    uint32_t component_of(vertex_t u) const { return component[u]; }
+
+    /**
+     * the condensation dag, components numbered in topological order
+     */
+    const CSRGraph &condensation() const { return dag; }
+
+    /**
+     * whether there is a path from u to v, a vertex reaches itself
+     * @param u: source vertex
+     * @param v: target vertex
+     * @return: true if v is reachable from u
+     */
+    bool reachable(vertex_t u, vertex_t v) const {
+        uint32_t a = component[u], b = component[v];
+        if(a == b) return true;
+        if(b < a) return false;
+        if(!closure.empty())
+            return closure[row_offset(num_components(), a) + (b >> 6) - (a >> 6)] >> (b & 63) & 1;
+        return search(a, b);
+    }
+
+    /**
+     * save the index as a binary file
+     * @param path: path of the file
+     * return: false if the file can't be written
+     */
+    bool save(const string &path) const {
+        ofstream out(path, ios::binary);
+        if(!out) return false;
+        ReachFileHeader header;
+        memcpy(header.magic, REACH_FILE_MAGIC, sizeof(header.magic));
+        header.version = REACH_FILE_VERSION;
+        header.flags = closure_mode() ? REACH_FILE_CLOSURE : 0;
+        header.num_vertices = component.size();
+        header.num_components = num_components();
+        header.num_dag_edges = dag.num_edges();
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        write(out, component.data(), component.size());
+        write(out, dag.offsets().begin(), dag.offsets().size());
+        write(out, dag.targets().begin(), dag.targets().size());
+        if(closure_mode())
+            write(out, closure.data(), closure.size());
+        else
+        {
+            write(out, post.data(), post.size());
+            write(out, tree_low.data(), tree_low.size());
+            write(out, low.data(), low.size());
+        }
+        return static_cast<bool>(out);
+    }
+
+    /**
+     * load an index saved by save()
+     *  the header, the sizes, the component ids and the dag offsets are checked
+     * @param path: path of the file
+     * @param index: save the index
+     * return: false if the file can't be read or is not a valid index file
+     */
+    static bool load(const string &path, ReachIndex &index) {
+        ifstream in(path, ios::binary);
+        ReachFileHeader header;
+        if(!in.read(reinterpret_cast<char *>(&header), sizeof(header))
+           || memcmp(header.magic, REACH_FILE_MAGIC, sizeof(header.magic)) != 0
+           || header.version != REACH_FILE_VERSION || header.num_vertices > UINT32_MAX
+           || header.num_components > header.num_vertices)
+            return false;
+        in.seekg(0, ios::end);
+        uint64_t file_size = in.tellg();
+        in.seekg(sizeof(header));
+
+        ReachIndex res;
+        size_t count = header.num_components;
+        bool closure_file = header.flags & REACH_FILE_CLOSURE;
+        uint64_t expected = sizeof(header) + 4 * header.num_vertices + 8 * (count + 1) + 4 * header.num_dag_edges
+                            + (closure_file ? 8 * row_offset(count, count) : 12 * count);
+        if(header.num_dag_edges > file_size || expected != file_size)
+            return false;
+
+        auto data = make_shared<pair<vector<CSRGraph::edge_t>, vector<vertex_t>>>();
+        bool ok = read(in, res.component, header.num_vertices)
+                  && read(in, data->first, count + 1) && read(in, data->second, header.num_dag_edges)
+                  && (closure_file ? read(in, res.closure, row_offset(count, count))
+                                   : read(in, res.post, count) && read(in, res.tree_low, count)
+                                     && read(in, res.low, count));
+        if(!ok || data->first[0] != 0 || data->first[count] != header.num_dag_edges)
+            return false;
+        for(size_t c = 0; c != count; ++c)
+            if(data->first[c] > data->first[c + 1])
+                return false;
+        for(auto c: res.component)
+            if(c >= count)
+                return false;
+        for(auto b: data->second)
+            if(b >= count)
+                return false;
+        res.dag = CSRGraph::view(data, count, header.num_dag_edges, data->first.data(), data->second.data(), nullptr);
+        index = move(res);
+        return true;
+    }
+
+private:
+    /**
+     * words of the closure before row c, row i keeps words [i/64, W) of W = ceil(C/64)
+     */
+    static size_t row_offset(size_t count, size_t c) {
+        size_t words = (count + 63) / 64, b = c >> 6;
+        return 64 * (b * words - b * (b - 1) / 2) + (c & 63) * (words - b);
+    }
+
+    void build_closure() {
+        size_t count = num_components(), words = (count + 63) / 64;
+        closure.assign(row_offset(count, count), 0);
+        for(size_t q0 = 0; q0 < words; q0 += REACH_CHUNK_WORDS)
+        {
+            size_t q1 = min(words, q0 + REACH_CHUNK_WORDS);
+            for(size_t c = count; c-- > 0;)
+            {
+                size_t first = c >> 6;
+                if(first >= q1) continue;
+                uint64_t *row = closure.data() + row_offset(count, c) - first; //indexed by absolute word
+                if(first >= q0)
+                    row[first] |= uint64_t(1) << (c & 63);
+                for(auto s: dag.neighbors(c))
+                {
+                    const uint64_t *succ = closure.data() + row_offset(count, s) - (s >> 6);
+                    for(size_t q = max<size_t>(q0, s >> 6); q < q1; ++q)
+                        row[q] |= succ[q];
+                }
+            }
+        }
+    }
+
+    /**
+     * visitor numbering the components in postorder, successors finish first on a dag
+     */
+    struct IntervalVisitor : DFSVisitor {
+        ReachIndex &index;
+        uint32_t next = 0;
+
+        explicit IntervalVisitor(ReachIndex &index) : index(index) {}
+
+        void discover(vertex_t c) { index.tree_low[c] = next; }
+
+        void finish(vertex_t c) {
+            index.post[c] = next++;
+            index.low[c] = index.tree_low[c];
+            for(auto s: index.dag.neighbors(c))
+                index.low[c] = min(index.low[c], index.low[s]);
+        }
+    };
+
+    void build_intervals() {
+        size_t count = num_components();
+        post.resize(count);
+        tree_low.resize(count);
+        low.resize(count);
+        IntervalVisitor visitor(*this);
+        DFSEngine(dag).run_all(visitor);
+    }
+
+    /**
+     * whether a component may reach b by the intervals and the topological order
+     */
+    bool may_reach(uint32_t a, uint32_t b) const {
+        return a <= b && post[b] <= post[a] && low[a] <= low[b];
+    }
+
+    /**
+     * whether b is in the DFS subtree of c, which proves c reaches b
+     */
+    bool tree_contains(uint32_t c, uint32_t b) const {
+        return tree_low[c] <= post[b] && post[b] <= post[c];
+    }
+
+    /**
+     * DFS from a for b, components which can't reach b are pruned, a component whose DFS
+     * subtree contains b ends the search
+     *  visited components are stamped with the number of the query in a buffer of the thread,
+     *  so a query costs only the components it visits, and concurrent queries don't share it,
+     *  the stack is a buffer of the thread too, so queries don't allocate
+     */
+    bool search(uint32_t a, uint32_t b) const {
+        if(!may_reach(a, b)) return false;
+        if(tree_contains(a, b)) return true;
+
+        thread_local vector<uint32_t> stamp;
+        thread_local uint32_t query = 0;
+        if(stamp.size() < num_components())
+            stamp.resize(num_components(), 0);
+        if(++query == 0) //the stamps wrapped around
+        {
+            fill(stamp.begin(), stamp.end(), 0);
+            query = 1;
+        }
+
+        thread_local vector<uint32_t> s;
+        s.assign(1, a);
+        stamp[a] = query;
+        while(!s.empty())
+        {
+            uint32_t c = s.back();
+            s.pop_back();
+            if(tree_contains(c, b))
+                return true;
+            for(auto d: dag.neighbors(c))
+                if(stamp[d] != query && may_reach(d, b))
+                {
+                    stamp[d] = query;
+                    s.push_back(d);
+                }
+        }
+        return false;
+    }
+
+    template<typename T>
+    static void write(ostream &out, const T *data, size_t n) {
+        out.write(reinterpret_cast<const char *>(data), n * sizeof(T));
+    }
+
+    template<typename T>
+    static bool read(istream &in, vector<T> &data, size_t n) {
+        data.resize(n);
+        return static_cast<bool>(in.read(reinterpret_cast<char *>(data.data()), n * sizeof(T)));
+    }
+
+    vector<uint32_t> component;    //topologically ordered component of every vertex
+    CSRGraph dag;                  //condensation
+    vector<uint64_t> closure;      //rows of the transitive closure, empty in interval mode
+    vector<uint32_t> post, tree_low, low; //intervals, empty in closure mode
+};
+
+/**
+ * usage: SCC [graph.bin [index.bin]], read the graph from cin without the binary graph file,
+ * the reachability index is saved to index.bin and loaded back, queries "u v" are read from cin
+ */
+int main(int argc, char *argv[]){
+    CSRGraph graph;
+    if (argc > 1) {
+        if (!load_graph(argv[1], graph)) {
+            cerr << "can't load graph file " << argv[1] << endl;
+            return 1;
+        }
+    } else {
+        size_t num;
+        cout << "请输入顶点数:"; cin >> num;
+        cout << "请输入边数,再依次输入有向图的边:" << endl;
+        if (!read_graph(cin, num, graph)) {
+            cerr << "invalid edge list." << endl;
+            return 1;
+        }
+    }
+    CSRGraph rgraph = graph.transpose();
+
     cout << "Kosaraju algorithm: " << endl;
     TArray components = Kosaraju(graph, rgraph);
     if (!components.empty())
@@ -117,5 +838,45 @@ int main(){
             cout << endl;
         }
 
+    cout << "Pearce algorithm: " << endl;
+    SCCLabels labels = Pearce(graph);
+    TArray groups(labels.count);
+    for (size_t v = 0; v != labels.label.size(); ++v)
+        groups[labels.label[v]].push_back(v);
+    for (size_t i = 0; i != groups.size(); ++i)
+    {
+        cout << "Component " << i + 1 << ":";
+        for (auto ver : groups[i])
+            cout << ver << " ";
+        cout << endl;
+    }
+
+    cout << "Parallel SCC: ";
+    SCCLabels parallel = parallel_SCC(graph, rgraph);
+    cout << parallel.count << " components, "
+         << (parallel.label == canonical_labels(components, graph.num_vertices()).label ? "the same as"
+                                                                                         : "different from")
+         << " Kosaraju" << endl;
+
+    ReachIndex index = ReachIndex::build(graph);
+    if (argc > 2 && !(index.save(argv[2]) && ReachIndex::load(argv[2], index))) {
+        cerr << "can't save the reachability index to " << argv[2] << endl;
+        return 1;
+    }
+    const CSRGraph &dag = index.condensation();
+    cout << "Condensation: " << dag.num_vertices() << " components, " << dag.num_edges() << " edges, "
+         << (index.closure_mode() ? "transitive closure" : "interval labels") << endl;
+    cout << "Topological order:";
+    for (size_t v = 0; v != graph.num_vertices(); ++v)
+        cout << " " << v << "(" << index.component_of(v) << ")";
+    cout << endl;
+
+    cout << "请输入查询的顶点对 u v:" << endl;
+    long long u, v;
+    while (cin >> u >> v)
+        if (u >= 0 && v >= 0 && static_cast<size_t>(u) < graph.num_vertices()
+            && static_cast<size_t>(v) < graph.num_vertices())
+            cout << u << " -> " << v << ": " << (index.reachable(u, v) ? "yes" : "no") << endl;
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,193 @@
+/*
+ *  Copyright(c) 2018 Gang Zhang
+ *  All rights reserved.
+ *  Author: Gang Zhang
+ *  Creation date: 2026.10.17
+ *  Last modified: 2026.10.17
+ *
+ *  Function:
+ *      convert a text edge list into a binary graph file(see graph_io.h)
+ *      every line is "u v" or "u v w", lines starting with '#' or '%' are comments
+ *      vertex ids are below UINT32_MAX, which is kept as the "no vertex" mark, with --undirected
+ *      the edge ids are saved as int32 weights, so at most 2^31 edges are accepted
+ *      the file is mapped and cut into chunks at line ends, chunks are parsed in parallel
+ *      by from_chars, which needs c++17: g++ -std=c++17 -O2 -pthread graph_convert.cpp
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <charconv>
+#include <algorithm>
+
+#include "graph_io.h"
+
+using namespace std;
+
+using Edge = pair<CSRGraph::vertex_t, CSRGraph::vertex_t>;
+
+/**
+ * edges parsed from one chunk of the text
+ */
+struct ParsedChunk {
+    vector<Edge> edges;
+    vector<CSRGraph::weight_t> weights;
+    size_t lines = 0;
+    size_t error_line = 0; //line number in the chunk of the first invalid line, 0 if none
+    const char *error = "";  //what is wrong with the line
+};
+
+/**
+ * parse the lines of [first, last), which starts at a line start and ends at a line end
+ * @param first: pointer to the first char
+ * @param last: pointer after the last char
+ * @param weighted: every edge has a weight
+ * @param chunk: save the edges
+ * return: none
+ */
+void parse_chunk(const char *first, const char *last, bool weighted, ParsedChunk &chunk) {
+    auto skip_blank = [&last](const char *p) {
+        while (p != last && (*p == ' ' || *p == '\t' || *p == '\r'))
+            ++p;
+        return p;
+    };
+
+    const char *p = first;
+    while (p != last) {
+        const char *eol = static_cast<const char *>(memchr(p, '\n', last - p));
+        if (!eol) eol = last;
+        chunk.lines++;
+        p = skip_blank(p);
+        if (p != eol && *p != '#' && *p != '%') {
+            CSRGraph::vertex_t u, v;
+            CSRGraph::weight_t w = 0;
+            auto r = from_chars(p, eol, u);
+            bool ok = r.ec == errc();
+            if (ok) {
+                r = from_chars(skip_blank(r.ptr), eol, v);
+                ok = r.ec == errc();
+            }
+            if (ok && weighted) {
+                r = from_chars(skip_blank(r.ptr), eol, w);
+                ok = r.ec == errc();
+            }
+            if (!ok || skip_blank(r.ptr) != eol) {
+                chunk.error_line = chunk.lines;
+                chunk.error = r.ec == errc::result_out_of_range ? "number out of range" : "malformed edge";
+                return;
+            }
+            if (u == UINT32_MAX || v == UINT32_MAX) {
+                chunk.error_line = chunk.lines;
+                chunk.error = "vertex id must be below 4294967295";
+                return;
+            }
+            chunk.edges.emplace_back(u, v);
+            if (weighted)
+                chunk.weights.push_back(w);
+        }
+        p = eol == last ? last : eol + 1;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    bool weighted = false, undirected = false;
+    size_t num = 0, threads = max(thread::hardware_concurrency(), 1u);
+    vector<string> paths;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--weighted")
+            weighted = true;
+        else if (arg == "--undirected")
+            undirected = true;
+        else if (arg == "--vertices" && i + 1 < argc)
+            num = stoull(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc)
+            threads = max(stoull(argv[++i]), 1ull);
+        else
+            paths.push_back(arg);
+    }
+    if (paths.size() != 2 || (weighted && undirected) || num > UINT32_MAX) {
+        cerr << "usage: " << argv[0] << " [--weighted | --undirected] [--vertices n] [--threads n]"
+             << " edges.txt graph.bin" << endl;
+        return 1;
+    }
+
+    //map the text file
+    int fd = open(paths[0].c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        cerr << "can't open " << paths[0] << endl;
+        return 1;
+    }
+    size_t size = st.st_size;
+    const char *text = size ? static_cast<const char *>(mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0)) : "";
+    close(fd);
+    if (text == MAP_FAILED) {
+        cerr << "can't map " << paths[0] << endl;
+        return 1;
+    }
+
+    //cut the text into chunks at line ends, parse them in parallel
+    vector<size_t> cut{0};
+    for (size_t t = 1; t < threads; ++t) {
+        size_t pos = max(size * t / threads, cut.back());
+        const char *eol = static_cast<const char *>(memchr(text + pos, '\n', size - pos));
+        cut.push_back(eol ? eol - text + 1 : size);
+    }
+    cut.push_back(size);
+    vector<ParsedChunk> chunks(threads);
+    vector<thread> workers;
+    for (size_t t = 0; t != threads; ++t)
+        workers.emplace_back(parse_chunk, text + cut[t], text + cut[t + 1], weighted, ref(chunks[t]));
+    for (auto &worker: workers)
+        worker.join();
+
+    //collect the edges of all chunks in order
+    vector<Edge> edges;
+    vector<CSRGraph::weight_t> weights;
+    size_t lines = 0, max_vertex = 0, edge_count = 0;
+    for (auto &chunk: chunks) {
+        if (chunk.error_line) {
+            cerr << "invalid edge at line " << lines + chunk.error_line << ": " << chunk.error << endl;
+            return 1;
+        }
+        lines += chunk.lines;
+        edge_count += chunk.edges.size();
+    }
+    if (undirected && edge_count > static_cast<size_t>(INT32_MAX) + 1) {
+        cerr << edge_count << " edges, the edge ids of an undirected graph are int32, at most 2^31 edges" << endl;
+        return 1;
+    }
+    edges.reserve(undirected ? 2 * edge_count : edge_count);
+    for (auto &chunk: chunks) {
+        for (size_t i = 0; i != chunk.edges.size(); ++i) {
+            const auto &e = chunk.edges[i];
+            max_vertex = max<size_t>(max_vertex, max(e.first, e.second));
+            edges.push_back(e);
+            if (undirected) {
+                edges.emplace_back(e.second, e.first);
+                weights.push_back(edges.size() / 2 - 1);
+                weights.push_back(edges.size() / 2 - 1);
+            }
+        }
+        weights.insert(weights.end(), chunk.weights.begin(), chunk.weights.end());
+        vector<Edge>().swap(chunk.edges);
+    }
+    if (size)
+        munmap(const_cast<char *>(text), size);
+
+    if (!edges.empty() && max_vertex >= num)
+        num = max_vertex + 1;
+    CSRGraph graph = CSRGraph::from_edges(num, edges, weights);
+    if (!save_graph(paths[1], graph)) {
+        cerr << "can't write " << paths[1] << endl;
+        return 1;
+    }
+    cout << paths[1] << ": " << graph.num_vertices() << " vertices, " << graph.num_edges() << " edges"
+         << (graph.weighted() ? ", weighted" : "") << endl;
+    return 0;
+}
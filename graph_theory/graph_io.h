@@ -0,0 +1,180 @@
+#ifndef ALGORITHMS_GRAPH_IO_H
+#define ALGORITHMS_GRAPH_IO_H
+
+/*
+ *  Copyright(c) 2018 Gang Zhang
+ *  All rights reserved.
+ *  Author: Gang Zhang
+ *  Creation date: 2026.10.17
+ *  Last modified: 2026.10.17
+ *
+ *  Function:
+ *      binary graph file, loaded by mmap without copying, and the interactive text loader
+ *      layout(native byte order, every section 8-byte aligned):
+ *          header          GraphFileHeader, 32 bytes
+ *          offsets         (num_vertices + 1) * uint64
+ *          targets         num_edges * uint32, padded to 8 bytes
+ *          weights         num_edges * int32, only if the GRAPH_FILE_WEIGHTED flag is set
+ *      text edge lists are converted to this format by graph_convert.cpp
+ */
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "CSR_graph.h"
+
+const char GRAPH_FILE_MAGIC[8] = {'C', 'S', 'R', 'G', 'R', 'A', 'P', 'H'};
+const uint32_t GRAPH_FILE_VERSION = 1;
+const uint32_t GRAPH_FILE_WEIGHTED = 1; //flag: the weights section exists
+
+struct GraphFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t num_vertices;
+    uint64_t num_edges;
+};
+
+/**
+ * bytes of the sections
+ */
+inline uint64_t graph_offsets_bytes(uint64_t num) { return (num + 1) * sizeof(CSRGraph::edge_t); }
+
+inline uint64_t graph_targets_bytes(uint64_t edges) { return (edges * sizeof(CSRGraph::vertex_t) + 7) / 8 * 8; }
+
+/**
+ * save the graph as a binary graph file
+ * @param path: path of the file
+ * @param graph: the graph
+ * return: false if the file can't be written
+ */
+inline bool save_graph(const std::string &path, const CSRGraph &graph) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+
+    GraphFileHeader header;
+    std::memcpy(header.magic, GRAPH_FILE_MAGIC, sizeof(header.magic));
+    header.version = GRAPH_FILE_VERSION;
+    header.flags = graph.weighted() ? GRAPH_FILE_WEIGHTED : 0;
+    header.num_vertices = graph.num_vertices();
+    header.num_edges = graph.num_edges();
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    auto offsets = graph.offsets();
+    auto targets = graph.targets();
+    out.write(reinterpret_cast<const char *>(offsets.begin()), graph_offsets_bytes(header.num_vertices));
+    out.write(reinterpret_cast<const char *>(targets.begin()), targets.size() * sizeof(CSRGraph::vertex_t));
+    const char padding[8] = {};
+    out.write(padding, graph_targets_bytes(header.num_edges) - targets.size() * sizeof(CSRGraph::vertex_t));
+    if (graph.weighted()) {
+        auto weights = graph.edge_weights();
+        out.write(reinterpret_cast<const char *>(weights.begin()), weights.size() * sizeof(CSRGraph::weight_t));
+    }
+    return static_cast<bool>(out);
+}
+
+/**
+ * load a binary graph file by mmap, the graph views the mapped pages directly,
+ * pages are read on the first access and unmapped with the last copy of the graph
+ *  the header and the file size are always checked, with validate the offsets are checked to be
+ *  non-decreasing and the targets to be vertices, O(|V|+|E|) reads of the whole file, skip it
+ *  only for trusted files
+ * @param path: path of the file
+ * @param graph: save the graph
+ * @param validate: check the offsets and the targets
+ * return: false if the file can't be mapped or is not a valid graph file
+ */
+inline bool load_graph(const std::string &path, CSRGraph &graph, bool validate = true) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < sizeof(GraphFileHeader)) {
+        close(fd);
+        return false;
+    }
+    size_t size = st.st_size;
+    void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); //the mapping keeps the file
+    if (addr == MAP_FAILED) return false;
+    std::shared_ptr<const void> owner(addr, [size](const void *p) { munmap(const_cast<void *>(p), size); });
+
+    const char *base = static_cast<const char *>(addr);
+    GraphFileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, GRAPH_FILE_MAGIC, sizeof(header.magic)) != 0
+        || header.version != GRAPH_FILE_VERSION || header.num_vertices > UINT32_MAX)
+        return false;
+
+    bool weighted = header.flags & GRAPH_FILE_WEIGHTED;
+    uint64_t offsets_pos = sizeof(header);
+    uint64_t targets_pos = offsets_pos + graph_offsets_bytes(header.num_vertices);
+    uint64_t weights_pos = targets_pos + graph_targets_bytes(header.num_edges);
+    uint64_t end = weights_pos + (weighted ? header.num_edges * sizeof(CSRGraph::weight_t) : 0);
+    if (header.num_edges > size || end != size)
+        return false;
+
+    auto offsets = reinterpret_cast<const CSRGraph::edge_t *>(base + offsets_pos);
+    auto targets = reinterpret_cast<const CSRGraph::vertex_t *>(base + targets_pos);
+    if (offsets[0] != 0 || offsets[header.num_vertices] != header.num_edges)
+        return false;
+    if (validate) {
+        for (uint64_t u = 0; u != header.num_vertices; ++u)
+            if (offsets[u] > offsets[u + 1])
+                return false;
+        for (uint64_t e = 0; e != header.num_edges; ++e)
+            if (targets[e] >= header.num_vertices)
+                return false;
+    }
+    graph = CSRGraph::view(owner, header.num_vertices, header.num_edges, offsets, targets,
+                           weighted ? reinterpret_cast<const CSRGraph::weight_t *>(base + weights_pos) : nullptr);
+    return true;
+}
+
+/**
+ * read a graph of num vertices from the edge count and the edges "u v" or "u v w"
+ * @param in: input stream
+ * @param num: number of vertices
+ * @param graph: save the graph
+ * @param weighted: every edge has a weight
+ * @param undirected: save every edge in both directions, the weights are the ids of the
+ *                    edges instead(see loop_method in Euler_path.cpp)
+ * return: false if the input ends early, or an edge is malformed or has a vertex out of range,
+ *         the graph is not changed then
+ */
+inline bool read_graph(std::istream &in, size_t num, CSRGraph &graph, bool weighted = false, bool undirected = false) {
+    size_t m = 0;
+    if (!(in >> m) || num > UINT32_MAX)
+        return false;
+    if (undirected && m > static_cast<size_t>(INT32_MAX) + 1) //edge ids are weights
+        return false;
+    std::vector<std::pair<CSRGraph::vertex_t, CSRGraph::vertex_t>> edges;
+    std::vector<CSRGraph::weight_t> weights;
+    long long u, v, w = 0;
+    for (size_t i = 0; i != m; ++i) {
+        if (!(in >> u >> v) || (weighted && !(in >> w)))
+            return false;
+        if (u < 0 || v < 0 || static_cast<size_t>(u) >= num || static_cast<size_t>(v) >= num
+            || w < INT32_MIN || w > INT32_MAX)
+            return false;
+        edges.emplace_back(u, v);
+        if (undirected) {
+            edges.emplace_back(v, u);
+            weights.push_back(i);
+            weights.push_back(i);
+        } else if (weighted)
+            weights.push_back(w);
+    }
+    graph = CSRGraph::from_edges(num, edges, weights);
+    return true;
+}
+
+#endif //ALGORITHMS_GRAPH_IO_H
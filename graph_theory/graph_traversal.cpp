@@ -7,7 +7,7 @@
  *
  *  Function:
  *      traversal algorithms for graph
- *      coding for graph saved by adjacent list
+ *      coding for graph saved in compressed sparse row format
  */
 
 #include <iostream>
@@ -29,20 +29,31 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include <numeric>
+#include <algorithm>
+
+#include "CSR_graph.h"
+#include "graph_io.h"
+#include "DFS_engine.h"
+#include "worker_group.h"
+
 using namespace std;
 
-using GraphList = vector<vector<int>>;
-using GraphMatrix = vector<vector<pair<int, int>>>
+#define NIL (-1)
+using GraphMatrix = vector<vector<pair<int, int>>>;
 
 /**
  * BFS for graph using queue
  * Time complexity: O(n)
- * @param graph: adjacent list of the graph
+ * @param graph: CSR graph
  * @param src: source vertex of the graph, default 0
  * @return: traversal sequence
  */
-vector<int> BFS(const GraphList &graph, size_t src=0){
-    size_t size = graph.size();
+vector<int> BFS(const CSRGraph &graph, size_t src=0){
+    size_t size = graph.num_vertices();
 
     vector<bool> visited(size, false);
     vector<int> seq;
@@ -54,7 +65,7 @@ vector<int> BFS(const GraphList &graph, size_t src=0){
     while(!q.empty())
     {
         int u = q.front(); q.pop();
-        for(const auto &v: graph[u])
+        for(const auto &v: graph.neighbors(u))
             if(!visited[v])
             {
                 q.push(v);
@@ -65,85 +76,344 @@ vector<int> BFS(const GraphList &graph, size_t src=0){
     return seq;
 }
 
+const size_t BFS_CHUNK = 256;               //vertices per chunk taken by a thread
+const double BFS_ALPHA = 14, BFS_BETA = 24; //thresholds to switch the direction of BFS
+const CSRGraph::vertex_t UNREACHED = UINT32_MAX; //parent and depth of unreached vertices
+
+struct BFSResult {
+    vector<CSRGraph::vertex_t> order;  //vertices level by level, the order in a level depends on threads
+    vector<CSRGraph::vertex_t> parent; //parent in the BFS tree, the source is its own parent, UNREACHED if unreached
+    vector<CSRGraph::vertex_t> depth;  //level of the vertices, UNREACHED if unreached
+};
+
 /**
- * DFS for graph using stack
- * Time complexity: O(n)|O(n^2)?
- * @param graph: adjacent lsit of the graph
- * @param src: source vertex of the graph, default 0
- * @return: traversal sequence
+ * direction-optimizing parallel BFS(Beamer):
+ *  level synchronous, every level is one of the two steps, done by one group of threads
+ *  kept for the whole search, levels of a few chunks are done by the caller alone
+ *  top-down step: scan the out-edges of the frontier, a vertex is claimed by the thread
+ *      whose CAS on its parent succeeds, claimed vertices go to the buffer of the thread
+ *  a chunk moves the buffer of its thread to its own stack and moves it back at the end, the
+ *  buffers of the threads share cache lines, but are written once per chunk, not per vertex
+ *  bottom-up step: every unvisited vertex scans its in-edges until it finds a parent in
+ *      the frontier bitmap, no atomic operation is needed, since one vertex is checked by
+ *      one thread, and the scan stops at the first parent
+ *  switch to bottom-up when the edges of the frontier m_f > m_u / ALPHA(m_u - edges of the
+ *  unvisited vertices), switch back when the frontier n_f < n / BETA and shrinks, so the
+ *  middle levels touching most edges are done bottom-up
+ * Time complexity: O(|V|+|E|) work, much fewer edges are checked on low-diameter graphs
+ * @param graph: CSR graph
+ * @param rgraph: reversed graph for the bottom-up steps, graph.transpose()
+ * @param src: source vertex of the graph
+ * @param threads: number of threads, 0 for all cores
+ * @return: BFS order, parent and depth of the vertices
  */
-vector<int> DFS(const GraphList &graph, size_t src=0){
-    size_t size = graph.size();
-    vector<int> visited(size, false);
-    vector<int> seq;
-    stack<int> s;
+BFSResult parallel_BFS(const CSRGraph &graph, const CSRGraph &rgraph, size_t src = 0, size_t threads = 0){
+    using vertex_t = CSRGraph::vertex_t;
+    size_t size = graph.num_vertices();
+    WorkerGroup group(threads);
+    threads = group.size();
 
-    s.push(src);
-    visited[src] = true;
-    seq.push_back(src);
-    while(!s.empty())
-    {
-        int u = s.top();
-        bool flag = false;
-        for(const auto &v: graph[u])
-            if(!visited[v])
-            {
-                s.push(v);
-                visited[v] = true;
-                seq.push_back(v);
-                flag = true;
-                break;
+    BFSResult res;
+    vector<atomic<vertex_t>> parent(size);
+    for (auto &p: parent)
+        p.store(UNREACHED, memory_order_relaxed);
+    res.depth.assign(size, UNREACHED);
+    parent[src].store(src, memory_order_relaxed);
+    res.depth[src] = 0;
+    res.order.push_back(src);
+
+    vector<vertex_t> frontier{static_cast<vertex_t>(src)};
+    vector<uint64_t> bitmap((size + 63) / 64);
+    vector<vector<vertex_t>> local(threads);
+    vector<size_t> local_edges(threads);
+    size_t edges_unvisited = graph.num_edges() - graph.degree(src);
+    size_t edges_frontier = graph.degree(src);
+    bool bottom_up = false, growing = true;
+
+    for (vertex_t level = 0; !frontier.empty(); ++level) {
+        if (!bottom_up && growing && edges_frontier > edges_unvisited / BFS_ALPHA)
+            bottom_up = true;
+        else if (bottom_up && !growing && frontier.size() < size / BFS_BETA)
+            bottom_up = false;
+
+        for (auto &buffer: local)
+            buffer.clear();
+        fill(local_edges.begin(), local_edges.end(), 0);
+        if (bottom_up) {
+            fill(bitmap.begin(), bitmap.end(), 0);
+            for (auto u: frontier)
+                bitmap[u >> 6] |= uint64_t(1) << (u & 63);
+            group.for_chunks(size, BFS_CHUNK, [&](size_t tid, size_t begin, size_t end) {
+                vector<vertex_t> next = move(local[tid]);
+                size_t edges = 0;
+                for (size_t v = begin; v != end; ++v) {
+                    if (res.depth[v] != UNREACHED) continue;
+                    for (auto u: rgraph.neighbors(v))
+                        if (bitmap[u >> 6] >> (u & 63) & 1) {
+                            parent[v].store(u, memory_order_relaxed);
+                            res.depth[v] = level + 1;
+                            next.push_back(v);
+                            edges += graph.degree(v);
+                            break;
+                        }
+                }
+                local[tid] = move(next);
+                local_edges[tid] += edges;
+            });
+        } else
+            group.for_chunks(frontier.size(), BFS_CHUNK, [&](size_t tid, size_t begin, size_t end) {
+                vector<vertex_t> next = move(local[tid]);
+                size_t edges = 0;
+                for (size_t i = begin; i != end; ++i) {
+                    vertex_t u = frontier[i];
+                    for (auto v: graph.neighbors(u)) {
+                        vertex_t expected = UNREACHED;
+                        if (parent[v].load(memory_order_relaxed) == UNREACHED
+                            && parent[v].compare_exchange_strong(expected, u, memory_order_relaxed)) {
+                            res.depth[v] = level + 1;
+                            next.push_back(v);
+                            edges += graph.degree(v);
+                        }
+                    }
+                }
+                local[tid] = move(next);
+                local_edges[tid] += edges;
+            });
+
+        size_t prev = frontier.size();
+        frontier.clear();
+        edges_frontier = 0;
+        for (size_t t = 0; t != threads; ++t) {
+            frontier.insert(frontier.end(), local[t].begin(), local[t].end());
+            edges_frontier += local_edges[t];
+        }
+        edges_unvisited -= edges_frontier;
+        res.order.insert(res.order.end(), frontier.begin(), frontier.end());
+        growing = frontier.size() > prev;
+    }
+
+    res.parent.resize(size);
+    for (size_t v = 0; v != size; ++v)
+        res.parent[v] = parent[v].load(memory_order_relaxed);
+    return res;
+}
+
+const size_t MS_BFS_MAX_SOURCES = 512; //sources of one batch, 8 words per vertex
+
+/**
+ * multi-source BFS of one batch, at most 64 * W sources
+ *  every vertex has W words of bits, bit i is set if the vertex is seen by source i
+ *  a level pushes the frontier bits of every frontier vertex to its neighbors by word-wide
+ *  OR, then the new bits of a vertex are next & ~seen, so one scan of the adjacency of a
+ *  vertex serves all sources which reach it at the same level
+ * @param graph: CSR graph
+ * @param sources: sources of the batch
+ * @param visit: called as visit(level, v, bits) when the sources in bits reach v at the level
+ * @param masks: save the ceil(k/64) words of seen bits of vertex v to masks[v * stride], nullptr
+ *               if the caller only needs visit
+ * @param stride: words between the masks of two vertices
+ * return: none
+ */
+template<size_t W, typename Visit>
+void multi_source_BFS_batch(const CSRGraph &graph, const vector<int> &sources, Visit visit,
+                            uint64_t *masks, size_t stride){
+    size_t size = graph.num_vertices();
+    vector<uint64_t> seen(size * W, 0), frontier(size * W, 0), next(size * W, 0);
+    for (size_t i = 0; i != sources.size(); ++i) {
+        seen[sources[i] * W + i / 64] |= uint64_t(1) << (i % 64);
+        frontier[sources[i] * W + i / 64] |= uint64_t(1) << (i % 64);
+    }
+    for (size_t v = 0; v != size; ++v)
+        if (any_of(&frontier[v * W], &frontier[v * W] + W, [](uint64_t x) { return x != 0; }))
+            visit(0, v, &frontier[v * W]);
+
+    for (int level = 1; ; ++level) {
+        for (size_t u = 0; u != size; ++u) {
+            const uint64_t *bits = &frontier[u * W];
+            uint64_t any = 0;
+            for (size_t k = 0; k != W; ++k)
+                any |= bits[k];
+            if (!any) continue;
+            for (auto v: graph.neighbors(u))
+                for (size_t k = 0; k != W; ++k)
+                    next[v * W + k] |= bits[k];
+        }
+
+        bool found = false;
+        for (size_t v = 0; v != size; ++v) {
+            uint64_t any = 0;
+            for (size_t k = 0; k != W; ++k) {
+                uint64_t bits = next[v * W + k] & ~seen[v * W + k];
+                seen[v * W + k] |= bits;
+                frontier[v * W + k] = bits;
+                next[v * W + k] = 0;
+                any |= bits;
+            }
+            if (any) {
+                visit(level, v, &frontier[v * W]);
+                found = true;
             }
-        if(!flag)
-            s.pop();
+        }
+        if (!found)
+            break;
     }
-    return seq;
+
+    if (masks) {
+        size_t words = (sources.size() + 63) / 64;
+        for (size_t v = 0; v != size; ++v)
+            copy(&seen[v * W], &seen[v * W] + words, masks + v * stride);
+    }
+}
+
+/**
+ * run a batch with the fewest words which hold its sources, see multi_source_BFS_batch
+ * return: none
+ */
+template<typename Visit>
+void multi_source_BFS_words(const CSRGraph &graph, const vector<int> &sources, Visit visit,
+                            uint64_t *masks = nullptr, size_t stride = 0){
+    if (sources.size() <= 64)
+        multi_source_BFS_batch<1>(graph, sources, visit, masks, stride);
+    else if (sources.size() <= 128)
+        multi_source_BFS_batch<2>(graph, sources, visit, masks, stride);
+    else if (sources.size() <= 256)
+        multi_source_BFS_batch<4>(graph, sources, visit, masks, stride);
+    else
+        multi_source_BFS_batch<MS_BFS_MAX_SOURCES / 64>(graph, sources, visit, masks, stride);
 }
 
 /**
- * recursive DFS for graph
- * @param graph: adjacent list of the graph
+ * multi-source BFS(MS-BFS), distances:
+ *  sources are run in batches of MS_BFS_MAX_SOURCES, every batch scans the adjacency once
+ *  per level for all of its sources
+ * Time complexity: O(k/512 * D * (|V|+|E|) * 8), D - diameter, k - number of sources
+ * @param graph: CSR graph
+ * @param sources: source vertices
+ * @return: dist[i][v] is the distance from sources[i] to v, NIL if unreachable
+ */
+vector<vector<int>> multi_source_BFS(const CSRGraph &graph, const vector<int> &sources){
+    vector<vector<int>> dist(sources.size(), vector<int>(graph.num_vertices(), NIL));
+    for (size_t first = 0; first < sources.size(); first += MS_BFS_MAX_SOURCES) {
+        vector<int> batch(sources.begin() + first,
+                          sources.begin() + min(first + MS_BFS_MAX_SOURCES, sources.size()));
+        size_t words = (batch.size() + 63) / 64;
+        multi_source_BFS_words(graph, batch, [&](int level, size_t v, const uint64_t *bits) {
+            for (size_t k = 0; k != words; ++k)
+                for (uint64_t b = bits[k]; b; b &= b - 1)
+                    dist[first + k * 64 + __builtin_ctzll(b)][v] = level;
+        });
+    }
+    return dist;
+}
+
+/**
+ * multi-source BFS(MS-BFS), reachability:
+ * @param graph: CSR graph
+ * @param sources: source vertices
+ * @return: masks of ceil(k/64) words per vertex, bit i of the masks of v is set if v is
+ *          reachable from sources[i]
+ */
+vector<uint64_t> multi_source_reach(const CSRGraph &graph, const vector<int> &sources){
+    size_t size = graph.num_vertices(), words = (sources.size() + 63) / 64;
+    vector<uint64_t> masks(size * words, 0);
+    for (size_t first = 0; first < sources.size(); first += MS_BFS_MAX_SOURCES) {
+        vector<int> batch(sources.begin() + first,
+                          sources.begin() + min(first + MS_BFS_MAX_SOURCES, sources.size()));
+        multi_source_BFS_words(graph, batch, [](int, size_t, const uint64_t *) {}, &masks[first / 64], words);
+    }
+    return masks;
+}
+
+/**
+ * visitor saving the vertices in discover order(preorder) or finish order(postorder)
+ */
+struct OrderVisitor : DFSVisitor {
+    vector<int> pre, post;
+
+    void discover(CSRGraph::vertex_t u) { pre.push_back(u); }
+
+    void finish(CSRGraph::vertex_t u) { post.push_back(u); }
+};
+
+/**
+ * DFS for graph by the iterative DFS engine(see DFS_engine.h)
+ * Time complexity: O(|V|+|E|), no recursion, so deep graphs don't overflow the stack
+ * @param graph: CSR graph
  * @param src: source vertex of the graph, default 0
  * @return: traversal sequence
  */
-void rDFS_child(const GraphList &graph, vector<int> &seq, vector<bool> &visited, int pos)
-{
-    visited[pos] = true;
-    seq.push_back(pos);
-    for(const auto &v: graph[pos])
-        if(!visited[v])
-            rDFS_child(graph, seq, visited, v);
+vector<int> DFS(const CSRGraph &graph, size_t src=0){
+    DFSEngine engine(graph);
+    OrderVisitor visitor;
+    engine.run(src, visitor);
+    return visitor.pre;
 }
 
-vector<int> rDFS(const GraphList &graph, size_t src=0){
-    size_t size = graph.size();
-    vector<bool> visited(size, false);
-    vector<int> seq;
-    rDFS_child(graph, seq, visited, src);
-    return seq;
+/**
+ * DFS for graph, vertices in finish order, i.e. every vertex after all vertices it reaches
+ * by the DFS tree
+ * Time complexity: O(|V|+|E|)
+ * @param graph: CSR graph
+ * @param src: source vertex of the graph, default 0
+ * @return: postorder sequence
+ */
+vector<int> DFS_postorder(const CSRGraph &graph, size_t src=0){
+    DFSEngine engine(graph);
+    OrderVisitor visitor;
+    engine.run(src, visitor);
+    return visitor.post;
 }
 
-int main(){
-    size_t num;
-    cout << "请输入顶点数:"; cin >> num;
-    vector<vector<int>> graph(num);
-
-    cout << "请依次输入有向图的边,以0 0结束:" << endl;
-    int u, v;
-    while (cin >> u >> v && !(u == 0 && v == 0))
-        graph[u].push_back(v);
+/**
+ * usage: graph_traversal [graph.bin], read the graph from cin without the binary graph file
+ */
+int main(int argc, char *argv[]){
+    CSRGraph graph;
+    if (argc > 1) {
+        if (!load_graph(argv[1], graph)) {
+            cerr << "can't load graph file " << argv[1] << endl;
+            return 1;
+        }
+    } else {
+        size_t num;
+        cout << "请输入顶点数:"; cin >> num;
+        cout << "请输入边数,再依次输入有向图的边:" << endl;
+        if (!read_graph(cin, num, graph)) {
+            cerr << "invalid edge list." << endl;
+            return 1;
+        }
+    }
+    if (graph.num_vertices() == 0)
+        return 0;
 
     auto seq1 = BFS(graph, 0);
     for(const auto &v: seq1)
         cout << v << " ";
     cout << endl;
 
+    auto res = parallel_BFS(graph, graph.transpose(), 0);
+    for(size_t v = 0; v != res.depth.size(); ++v)
+        if(res.depth[v] != UNREACHED)
+            cout << v << "(" << res.depth[v] << ") ";
+    cout << endl;
+
+    vector<int> sources(min<size_t>(graph.num_vertices(), 4));
+    iota(sources.begin(), sources.end(), 0);
+    auto dist = multi_source_BFS(graph, sources);
+    for(size_t i = 0; i != sources.size(); ++i)
+    {
+        cout << sources[i] << ":";
+        for(const auto &d: dist[i])
+            cout << " " << d;
+        cout << endl;
+    }
+
     auto seq2 = DFS(graph, 0);
     for(const auto &v: seq2)
         cout << v << " ";
     cout << endl;
 
-    auto seq3 = rDFS(graph, 0);
+    auto seq3 = DFS_postorder(graph, 0);
     for(const auto &v: seq3)
         cout << v << " ";
     cout << endl;
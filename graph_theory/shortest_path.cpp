@@ -28,12 +28,15 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include "CSR_graph.h"
+#include "graph_io.h"
+#include "../common/perf_counter.h"
+
 using namespace std;
 
 #define NIL (-1)
 #define INFINITY 0x3f3f3f3f
 using GraphMatrix = vector<vector<int>>;
-using GraphList = vector<vector<pair<int, int>>>;
 
 vector<int> dist; //distance of all vertices to source vertex
 vector<int> preV; //prior vertex of all vertices on the shortest path to source vertex
@@ -107,6 +110,7 @@ void PrintFloyd(const GraphMatrix &dist, int u, int v) {
  * return: none
  */
 void push_down(vector<int> &heap, vector<int> &position, int pos, int size) {
+    PERF_COUNT(HEAP_OPS);
     int cur = pos;
     int vertex = heap[pos];
     int value = dist[vertex];
@@ -132,6 +136,7 @@ void push_down(vector<int> &heap, vector<int> &position, int pos, int size) {
  * return: none
  */
 void push_up(vector<int> &heap, vector<int> &position, int pos) {
+    PERF_COUNT(HEAP_OPS);
     int cur = pos;
     int vertex = heap[pos];
     int value = dist[vertex];
@@ -156,18 +161,17 @@ void push_up(vector<int> &heap, vector<int> &position, int pos) {
  * Time complexity:
  *   O(|E|*lg|V|) -- adjacent list
  *   O(|V|^2) -- adjacent matrix
- * @param graph: adjacent list of the graph
+ * @param graph: weighted CSR graph
  * @param src: source vertex of the graph
  * return: false if there is a negative weighted edge else true
  */
-bool Dijkstra(const GraphList &graph, int src = 0) {
+bool Dijkstra(const CSRGraph &graph, int src = 0) {
     //check whether any negative edge exists
-    for (const auto &arr: graph)
-        for (const auto &item: arr)
-            if (item.second < 0)
-                return false;
+    for (const auto &w: graph.edge_weights())
+        if (w < 0)
+            return false;
 
-    auto size = graph.size();
+    auto size = graph.num_vertices();
     vector<int> heap(2);
     vector<int> position(size); //save position of vertices in the heap
     int qsize = size;
@@ -192,11 +196,14 @@ bool Dijkstra(const GraphList &graph, int src = 0) {
         push_down(heap, position, 1, qsize);
 
         //update adjacent vertices
-        for (const auto &item: graph[u]) {
-            int v = item.first;
-            if (dist[u] + item.second < dist[v]) {
+        auto neighbors = graph.neighbors(u);
+        auto weights = graph.weights(u);
+        for (size_t k = 0; k != neighbors.size(); ++k) {
+            int v = neighbors[k];
+            if (dist[u] + weights[k] < dist[v]) {
+                PERF_COUNT(RELAXATIONS);
                 preV[v] = u;
-                dist[v] = dist[u] + item.second;
+                dist[v] = dist[u] + weights[k];
                 push_up(heap, position, position[v]);
             }//if
         }//for
@@ -244,16 +251,22 @@ GraphMatrix Floyd_Warshall(const GraphMatrix &graph) {
 
 /**
  * test function for Dijkstra algorithm
- * @param graph: adjacent list of the graph
+ * @param graph: weighted CSR graph
  * @param src: source vertex of the graph
  * return: none
  */
-void test_for_dijkstra(const GraphList &graph, int src) {
-    size_t size = graph.size();
+void test_for_dijkstra(const CSRGraph &graph, int src) {
+    size_t size = graph.num_vertices();
 
     preV = vector<int>(size, NIL);
     dist = vector<int>(size, INFINITY);
-    if (Dijkstra(graph, src))
+    bool non_negative = false;
+#ifdef ALGO_PERF
+    perf::measure("Dijkstra", [&] { non_negative = Dijkstra(graph, src); }).print();
+#else
+    non_negative = Dijkstra(graph, src);
+#endif
+    if (non_negative)
         print_path(src);
     else
         cout << "There is a negative-weight edge." << endl;
@@ -287,27 +300,57 @@ void test_for_floyd(const GraphMatrix &graph) {
     }
 }
 
-int main() {
-    unsigned num, u, v, w;
-    cout << "请输入顶点数:";
-    cin >> num;
-
-    GraphList graph1(num);
-    GraphMatrix graph2(num, vector<int>(num, INFINITY));
-    for (int i = 0; i != num; ++i)
-        graph2[i][i] = 0;
+const size_t FLOYD_MAX_VERTICES = 1 << 12; //the distance matrix of floyd takes O(|V|^2) space
 
-    cout << "请依次输入有向图的边,以0 0 0结束:" << endl;
-    while (cin >> u >> v >> w && !(u == 0 && v == 0)) {
-        graph1[u].emplace_back(v, w);
-        graph2[u][v] = w;
+/**
+ * usage: shortest_path [graph.bin], read the graph from cin without the binary graph file
+ *  the binary graph file should be converted by graph_convert --weighted
+ */
+int main(int argc, char *argv[]) {
+    CSRGraph graph1;
+    if (argc > 1) {
+        if (!load_graph(argv[1], graph1)) {
+            cerr << "can't load graph file " << argv[1] << endl;
+            return 1;
+        }
+    } else {
+        size_t num;
+        cout << "请输入顶点数:";
+        cin >> num;
+        cout << "请输入边数,再依次输入有向图的边和权值:" << endl;
+        if (!read_graph(cin, num, graph1, true)) {
+            cerr << "invalid edge list." << endl;
+            return 1;
+        }
+    }
+    size_t num = graph1.num_vertices();
+    if (num == 0)
+        return 0;
+    if (graph1.num_edges() != 0 && !graph1.weighted()) {
+        cerr << "the graph is not weighted." << endl;
+        return 1;
     }
 
     cout << "输入源点:";
     int src;
     cin >> src;
-
+    if (src < 0 || static_cast<size_t>(src) >= num)
+        return 1;
     test_for_dijkstra(graph1, src);
+
+    if (num > FLOYD_MAX_VERTICES) {
+        cout << "too many vertices for floyd algorithm." << endl;
+        return 0;
+    }
+    GraphMatrix graph2(num, vector<int>(num, INFINITY));
+    for (size_t i = 0; i != num; ++i)
+        graph2[i][i] = 0;
+    for (CSRGraph::vertex_t u = 0; u != num; ++u) {
+        auto neighbors = graph1.neighbors(u);
+        auto weights = graph1.weights(u);
+        for (size_t k = 0; k != neighbors.size(); ++k)
+            graph2[u][neighbors[k]] = weights[k];
+    }
     test_for_floyd(graph2);
 
     return 0;
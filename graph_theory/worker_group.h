@@ -0,0 +1,123 @@
+#ifndef ALGORITHMS_WORKER_GROUP_H
+#define ALGORITHMS_WORKER_GROUP_H
+
+/*
+ *  Copyright(c) 2018 Gang Zhang
+ *  All rights reserved.
+ *  Author: Gang Zhang
+ *  Creation date: 2026.10.17
+ *  Last modified: 2026.10.17
+ *
+ *  Function:
+ *      a group of threads kept alive for a whole graph algorithm, level synchronous
+ *      algorithms run every level on the same threads instead of creating new ones
+ */
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <condition_variable>
+
+const size_t WORKER_INLINE_CHUNKS = 4; //ranges of at most this many chunks run on the caller only
+
+/**
+ * persistent worker threads:
+ *  for_chunks() wakes the workers by a generation counter, the caller works too and returns
+ *  when all workers are done, so every call is a barrier
+ *  small ranges are run by the caller alone, a level of a few vertices costs no wake-up
+ */
+class WorkerGroup {
+public:
+    /**
+     * @param threads: number of threads including the caller, 0 for all cores
+     */
+    explicit WorkerGroup(size_t threads = 0) {
+        if (threads == 0)
+            threads = std::max(std::thread::hardware_concurrency(), 1u);
+        for (size_t t = 1; t < threads; ++t)
+            workers.emplace_back([this, t] { work(t); });
+    }
+
+    ~WorkerGroup() {
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            stop = true;
+        }
+        start_cv.notify_all();
+        for (auto &t: workers)
+            t.join();
+    }
+
+    WorkerGroup(const WorkerGroup &) = delete;
+
+    WorkerGroup &operator=(const WorkerGroup &) = delete;
+
+    size_t size() const { return workers.size() + 1; }
+
+    /**
+     * run f(tid, begin, end) on chunks of [0, n), a thread takes the next chunk when it
+     * finishes one, so threads stay busy when the work of items is unbalanced
+     * @param n: number of items
+     * @param chunk: items per chunk
+     * @param f: work of a chunk, tid is in [0, size())
+     * return: none
+     */
+    template<typename F>
+    void for_chunks(size_t n, size_t chunk, F f) {
+        if (workers.empty() || n <= WORKER_INLINE_CHUNKS * chunk) {
+            for (size_t begin = 0; begin < n; begin += chunk)
+                f(0, begin, std::min(begin + chunk, n));
+            return;
+        }
+
+        std::atomic<size_t> next(0);
+        std::function<void(size_t)> task = [&](size_t tid) {
+            for (size_t begin; (begin = next.fetch_add(chunk, std::memory_order_relaxed)) < n;)
+                f(tid, begin, std::min(begin + chunk, n));
+        };
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            job = &task;
+            running = workers.size();
+            generation++;
+        }
+        start_cv.notify_all();
+        task(0);
+        std::unique_lock<std::mutex> lk(mtx);
+        done_cv.wait(lk, [this] { return running == 0; });
+        job = nullptr;
+    }
+
+private:
+    void work(size_t tid) {
+        uint64_t seen = 0;
+        while (true) {
+            std::function<void(size_t)> *task;
+            {
+                std::unique_lock<std::mutex> lk(mtx);
+                start_cv.wait(lk, [&] { return stop || generation != seen; });
+                if (stop) return;
+                seen = generation;
+                task = job;
+            }
+            (*task)(tid);
+            std::lock_guard<std::mutex> lk(mtx);
+            if (--running == 0)
+                done_cv.notify_one();
+        }
+    }
+
+    std::mutex mtx;
+    std::condition_variable start_cv, done_cv;
+    std::function<void(size_t)> *job = nullptr; //work of the current call
+    uint64_t generation = 0;                    //number of calls, a new one wakes the workers
+    size_t running = 0;                         //workers still in the current call
+    bool stop = false;
+    std::vector<std::thread> workers;
+};
+
+#endif //ALGORITHMS_WORKER_GROUP_H
@@ -12,8 +12,12 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <iterator>
 
 #include <cmath>
+#include <cstdio>
+#include <climits>
+#include <cstdint>
 #include <list>
 #include <array>
 #include <deque>
@@ -29,6 +33,23 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <future>
+#include <random>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SORT_HAVE_AVX2
+#endif
+
+#include "sort.h"
+#include "../common/perf_counter.h"
+
 using namespace std;
 
 /**
@@ -39,6 +60,7 @@ using namespace std;
  * return: none
  */
 void swap(int i, int j, vector<int> &arr) {
+    PERF_COUNT(SWAPS);
     int tmp = arr[i];
     arr[i] = arr[j];
     arr[j] = tmp;
@@ -58,6 +80,7 @@ void bubble_sort(vector<int> &arr) {
     for (int i = 0; i < sz - 1;) {
         int next = sz - 1; //record the last exchange position
         for (int j = sz - 1; j != i; --j) {
+            PERF_COUNT(COMPARISONS);
             if (arr[j] < arr[j - 1]) {
                 swap(j - 1, j, arr);
                 next = j;
@@ -67,9 +90,96 @@ void bubble_sort(vector<int> &arr) {
     }
 }
 
+/**
+ * small sort: sort at most SMALL_SORT_SIZE elements in arr[i..j]
+ *  avx2 version: pad the elements to 16 with INT_MAX, sort them by a bitonic sorting network
+ *      on two 8-lane registers, every compare-exchange is a min/max pair without branches
+ *  scalar version: insertion sort
+ *  the version is chosen at runtime by detecting the cpu features
+ * @param i: pos of the left-most element
+ * @param j: pos of the right-most element
+ * @param arr: reference of the original vector
+ * return: none
+ */
+const int SMALL_SORT_SIZE = 16;
+
+void small_sort_scalar(int i, int j, vector<int> &arr) {
+    for (int k = i + 1; k <= j; ++k) {
+        int tmp = arr[k], pos = k;
+        for (; pos > i && tmp < arr[pos - 1]; --pos)
+            arr[pos] = arr[pos - 1];
+        arr[pos] = tmp;
+    }
+}
+
+#ifdef SORT_HAVE_AVX2
+/**
+ * one compare-exchange step of the bitonic network:
+ *  every lane is compared with the lane given by perm,
+ *  lanes whose bit is set in MASK keep the maximum, the others keep the minimum
+ */
+template<int MASK>
+__attribute__((target("avx2"))) inline __m256i bitonic_step(__m256i v, __m256i perm) {
+    __m256i w = _mm256_permutevar8x32_epi32(v, perm);
+    return _mm256_blend_epi32(_mm256_min_epi32(v, w), _mm256_max_epi32(v, w), MASK);
+}
+
+//sort a bitonic sequence in one register
+__attribute__((target("avx2"))) inline __m256i bitonic_merge8(__m256i v) {
+    const __m256i xor4 = _mm256_setr_epi32(4, 5, 6, 7, 0, 1, 2, 3);
+    const __m256i xor2 = _mm256_setr_epi32(2, 3, 0, 1, 6, 7, 4, 5);
+    const __m256i xor1 = _mm256_setr_epi32(1, 0, 3, 2, 5, 4, 7, 6);
+    v = bitonic_step<0xF0>(v, xor4);
+    v = bitonic_step<0xCC>(v, xor2);
+    return bitonic_step<0xAA>(v, xor1);
+}
+
+//sort 8 elements in one register
+__attribute__((target("avx2"))) inline __m256i bitonic_sort8(__m256i v) {
+    const __m256i xor2 = _mm256_setr_epi32(2, 3, 0, 1, 6, 7, 4, 5);
+    const __m256i xor1 = _mm256_setr_epi32(1, 0, 3, 2, 5, 4, 7, 6);
+    v = bitonic_step<0x66>(v, xor1);
+    v = bitonic_step<0x3C>(v, xor2);
+    v = bitonic_step<0x5A>(v, xor1);
+    return bitonic_merge8(v);
+}
+
+__attribute__((target("avx2"))) void small_sort_avx2(int i, int j, vector<int> &arr) {
+    int n = j - i + 1;
+    alignas(32) int buf[16];
+    for (int k = 0; k != 16; ++k)
+        buf[k] = k < n ? arr[i + k] : INT_MAX;
+
+    __m256i a = bitonic_sort8(_mm256_load_si256(reinterpret_cast<__m256i *>(buf)));
+    if (n > 8) {
+        //merge two sorted registers: reverse the second one, then both halves are bitonic
+        const __m256i rev = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+        __m256i b = bitonic_sort8(_mm256_load_si256(reinterpret_cast<__m256i *>(buf + 8)));
+        b = _mm256_permutevar8x32_epi32(b, rev);
+        __m256i lo = _mm256_min_epi32(a, b), hi = _mm256_max_epi32(a, b);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(buf + 8), bitonic_merge8(hi));
+        a = bitonic_merge8(lo);
+    }
+    _mm256_store_si256(reinterpret_cast<__m256i *>(buf), a);
+    for (int k = 0; k != n; ++k)
+        arr[i + k] = buf[k];
+}
+#endif
+
+void small_sort(int i, int j, vector<int> &arr) {
+#ifdef SORT_HAVE_AVX2
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    if (has_avx2) {
+        small_sort_avx2(i, j, arr);
+        return;
+    }
+#endif
+    small_sort_scalar(i, j, arr);
+}
+
 /**
  * quick sort(not stable):
- *  optimization_1: use insert sort when number of the elements is small
+ *  optimization_1: use sorting network when number of the elements is small
  *  optimization_2: choose median of the three elements as pivot
  *  note: consider the situation that all elements were divided into a single part
  *  time complexity: average-O(nlogn), worst-O(n^2)
@@ -79,10 +189,8 @@ void bubble_sort(vector<int> &arr) {
  * return: none
  */
 void quick_sort_child(int i, int j, vector<int> &arr) {
-    //maybe shoud replace this code block with inserting sort
-    if (j - i < 2) {
-        if (i < j && arr[i] > arr[j])
-            swap(i, j, arr);
+    if (j - i < SMALL_SORT_SIZE) {
+        small_sort(i, j, arr);
         return;
     }
 
@@ -99,8 +207,8 @@ void quick_sort_child(int i, int j, vector<int> &arr) {
     //partition elements
     int left = i, right = j;
     while (left < right) {
-        while (arr[left] < pivot) left++;
-        while (arr[right] >= pivot) right--;
+        while (PERF_COUNT(COMPARISONS), arr[left] < pivot) left++;
+        while (right > left && (PERF_COUNT(COMPARISONS), arr[right] >= pivot)) right--; //never step out of [i, j]
         if (left < right)
             swap(left, right, arr);
     }
@@ -120,36 +228,578 @@ void quick_sort(vector<int> &arr) {
     quick_sort_child(0, arr.size() - 1, arr);
 }
 
+/**
+ * intro sort(not stable):
+ *  pattern-defeating quick sort, keeps quick sort fast on the inputs that break it
+ *  optimization_1: sorted or reversed input is detected by one scan before sorting
+ *  optimization_2: median of three(ninther for big parts) as pivot
+ *  optimization_3: block partition, elements to swap are collected into offset buffers
+ *      by comparisons without branches, then swapped in a batch
+ *  optimization_4: pivot equal to the element before the part means many duplicates,
+ *      all elements equal to pivot are put together and never touched again(fat partition)
+ *  optimization_5: a partition that swaps nothing hints a nearly sorted part,
+ *      try finishing it with a partial insertion sort
+ *  optimization_6: highly unbalanced partitions shuffle some elements to break the pattern,
+ *      after log(n) bad partitions switch to heap sort
+ *  time complexity: O(nlogn), O(n) on sorted, reversed or all-equal input
+ *  space complexity: O(logn) - space for recursive operation
+ * note: intervals here are [begin, end), which differs from [i, j] of quick_sort_child
+ */
+const int NINTHER_THRESHOLD = 128;
+const int PARTIAL_INSERTION_SORT_LIMIT = 8;
+const int PARTITION_BLOCK_SIZE = 64;
+
+void heap_sort_range(int begin, int end, vector<int> &arr);
+
+/**
+ * sort three elements, the median is put at pos b
+ * return: none
+ */
+void sort3(int a, int b, int c, vector<int> &arr) {
+    if (arr[b] < arr[a]) swap(a, b, arr);
+    if (arr[c] < arr[b]) swap(b, c, arr);
+    if (arr[b] < arr[a]) swap(a, b, arr);
+}
+
+/**
+ * insertion sort which gives up after moving PARTIAL_INSERTION_SORT_LIMIT elements
+ * @param begin: pos of the first element
+ * @param end: pos after the last element
+ * @param arr: reference of the original vector
+ * return: true if [begin, end) is sorted
+ */
+bool partial_insertion_sort(int begin, int end, vector<int> &arr) {
+    int limit = 0;
+    for (int cur = begin + 1; cur < end; ++cur) {
+        if (arr[cur] < arr[cur - 1]) {
+            int tmp = arr[cur], pos = cur;
+            for (; pos > begin && tmp < arr[pos - 1]; --pos)
+                arr[pos] = arr[pos - 1];
+            arr[pos] = tmp;
+            limit += cur - pos;
+        }
+        if (limit > PARTIAL_INSERTION_SORT_LIMIT)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * partition around pivot arr[begin], elements equal to pivot go to the left part
+ *  only used when an element before begin equals to pivot, so the left part is all equal
+ * @param begin: pos of the first element
+ * @param end: pos after the last element
+ * @param arr: reference of the original vector
+ * return: pos of the pivot after partition
+ */
+int partition_left(int begin, int end, vector<int> &arr) {
+    int pivot = arr[begin];
+    int first = begin, last = end;
+
+    while (pivot < arr[--last]);
+    if (last + 1 == end)
+        while (first < last && !(pivot < arr[++first]));
+    else
+        while (!(pivot < arr[++first]));
+
+    while (first < last) {
+        swap(first, last, arr);
+        while (pivot < arr[--last]);
+        while (!(pivot < arr[++first]));
+    }
+
+    arr[begin] = arr[last];
+    arr[last] = pivot;
+    return last;
+}
+
+/**
+ * swap the elements recorded in the offset buffers
+ *  when the two buffers are not equal sized, a cyclic permutation saves a move per element
+ * return: none
+ */
+void swap_offsets(int first, int last, const unsigned char *offsets_l, const unsigned char *offsets_r,
+                  int num, bool use_swaps, vector<int> &arr) {
+    if (use_swaps) {
+        for (int k = 0; k != num; ++k)
+            swap(first + offsets_l[k], last - offsets_r[k], arr);
+    } else if (num > 0) {
+        int l = first + offsets_l[0], r = last - offsets_r[0];
+        int tmp = arr[l];
+        arr[l] = arr[r];
+        for (int k = 1; k != num; ++k) {
+            l = first + offsets_l[k];
+            arr[r] = arr[l];
+            r = last - offsets_r[k];
+            arr[l] = arr[r];
+        }
+        arr[r] = tmp;
+    }
+}
+
+/**
+ * block partition around pivot arr[begin] without branches on comparison results,
+ *  elements equal to pivot go to the right part
+ *  a block of elements on each side is scanned, offsets of misplaced elements are recorded
+ *  by adding the comparison result to the buffer size, then the misplaced pairs are swapped
+ * @param begin: pos of the first element
+ * @param end: pos after the last element
+ * @param arr: reference of the original vector
+ * @param already_partitioned: set true if no element needs to be moved
+ * return: pos of the pivot after partition
+ */
+int partition_right_branchless(int begin, int end, vector<int> &arr, bool &already_partitioned) {
+    int pivot = arr[begin];
+    int first = begin, last = end;
+
+    //find the first element >= pivot, there is one at least due to the median of three
+    while (arr[++first] < pivot);
+    //find the first element < pivot from right, guard it if no element < pivot on the left
+    if (first - 1 == begin)
+        while (first < last && !(arr[--last] < pivot));
+    else
+        while (!(arr[--last] < pivot));
+
+    already_partitioned = first >= last;
+    if (!already_partitioned) {
+        swap(first, last, arr);
+        ++first;
+
+        alignas(64) unsigned char offsets_l[PARTITION_BLOCK_SIZE], offsets_r[PARTITION_BLOCK_SIZE];
+        int offsets_l_base = first, offsets_r_base = last;
+        int num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+        while (first < last) {
+            //fill the empty buffers, split the unknown elements if both are empty
+            int num_unknown = last - first;
+            int left_split = num_l == 0 ? (num_r == 0 ? num_unknown / 2 : num_unknown) : 0;
+            int right_split = num_r == 0 ? (num_unknown - left_split) : 0;
+            left_split = min(left_split, PARTITION_BLOCK_SIZE);
+            right_split = min(right_split, PARTITION_BLOCK_SIZE);
+
+            for (int k = 0; k != left_split; ++k) {
+                offsets_l[num_l] = k;
+                num_l += !(arr[first] < pivot);
+                ++first;
+            }
+            for (int k = 0; k != right_split;) {
+                offsets_r[num_r] = ++k;
+                num_r += arr[--last] < pivot;
+            }
+
+            //swap as many elements as possible
+            int num = min(num_l, num_r);
+            swap_offsets(offsets_l_base, offsets_r_base, offsets_l + start_l, offsets_r + start_r,
+                         num, num_l == num_r, arr);
+            num_l -= num;
+            num_r -= num;
+            start_l += num;
+            start_r += num;
+            if (num_l == 0) {
+                start_l = 0;
+                offsets_l_base = first;
+            }
+            if (num_r == 0) {
+                start_r = 0;
+                offsets_r_base = last;
+            }
+        }
+
+        //all unknown elements are classified, move the rest misplaced elements to the border
+        if (num_l) {
+            while (num_l--)
+                swap(offsets_l_base + offsets_l[start_l + num_l], --last, arr);
+            first = last;
+        }
+        if (num_r) {
+            while (num_r--)
+                swap(offsets_r_base - offsets_r[start_r + num_r], first++, arr);
+            last = first;
+        }
+    }
+
+    int pivot_pos = first - 1;
+    arr[begin] = arr[pivot_pos];
+    arr[pivot_pos] = pivot;
+    return pivot_pos;
+}
+
+/**
+ * @param begin: pos of the first element
+ * @param end: pos after the last element
+ * @param arr: reference of the original vector
+ * @param bad_allowed: number of highly unbalanced partitions allowed before heap sort
+ * @param leftmost: whether no element exists before begin in the current sort
+ * return: none
+ */
+void intro_sort_child(int begin, int end, vector<int> &arr, int bad_allowed, bool leftmost) {
+    while (true) {
+        int size = end - begin;
+        if (size <= SMALL_SORT_SIZE) {
+            if (size > 1)
+                small_sort(begin, end - 1, arr);
+            return;
+        }
+
+        //choose pivot and put it at begin
+        int s2 = size / 2;
+        if (size > NINTHER_THRESHOLD) {
+            sort3(begin, begin + s2, end - 1, arr);
+            sort3(begin + 1, begin + s2 - 1, end - 2, arr);
+            sort3(begin + 2, begin + s2 + 1, end - 3, arr);
+            sort3(begin + s2 - 1, begin + s2, begin + s2 + 1, arr);
+            swap(begin, begin + s2, arr);
+        } else
+            sort3(begin + s2, begin, end - 1, arr);
+
+        //elements before begin are <= all elements in the part, pivot equal to it means duplicates
+        if (!leftmost && !(arr[begin - 1] < arr[begin])) {
+            begin = partition_left(begin, end, arr) + 1;
+            continue;
+        }
+
+        bool already_partitioned;
+        int pivot_pos = partition_right_branchless(begin, end, arr, already_partitioned);
+        int l_size = pivot_pos - begin, r_size = end - (pivot_pos + 1);
+
+        if (l_size < size / 8 || r_size < size / 8) {
+            if (--bad_allowed == 0) {
+                heap_sort_range(begin, end, arr);
+                return;
+            }
+
+            //swap some elements to break the pattern
+            if (l_size > SMALL_SORT_SIZE) {
+                swap(begin, begin + l_size / 4, arr);
+                swap(pivot_pos - 1, pivot_pos - l_size / 4, arr);
+                if (l_size > NINTHER_THRESHOLD) {
+                    swap(begin + 1, begin + (l_size / 4 + 1), arr);
+                    swap(begin + 2, begin + (l_size / 4 + 2), arr);
+                    swap(pivot_pos - 2, pivot_pos - (l_size / 4 + 1), arr);
+                    swap(pivot_pos - 3, pivot_pos - (l_size / 4 + 2), arr);
+                }
+            }
+            if (r_size > SMALL_SORT_SIZE) {
+                swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4), arr);
+                swap(end - 1, end - r_size / 4, arr);
+                if (r_size > NINTHER_THRESHOLD) {
+                    swap(pivot_pos + 2, pivot_pos + (2 + r_size / 4), arr);
+                    swap(pivot_pos + 3, pivot_pos + (3 + r_size / 4), arr);
+                    swap(end - 2, end - (1 + r_size / 4), arr);
+                    swap(end - 3, end - (2 + r_size / 4), arr);
+                }
+            }
+        } else if (already_partitioned && partial_insertion_sort(begin, pivot_pos, arr)
+                   && partial_insertion_sort(pivot_pos + 1, end, arr))
+            return;
+
+        //recurse into the left part, loop on the right part
+        intro_sort_child(begin, pivot_pos, arr, bad_allowed, leftmost);
+        begin = pivot_pos + 1;
+        leftmost = false;
+    }
+}
+
+/**
+ * log2 of n, used as the number of bad partitions allowed
+ */
+int log2_floor(int n) {
+    int log = 0;
+    while (n >>= 1)
+        ++log;
+    return log;
+}
+
+void intro_sort(vector<int> &arr) {
+    int sz = arr.size();
+    if (sz < 2) return;
+
+    //detect the whole vector as a single ascending or descending run
+    int k = 1;
+    if (arr[1] < arr[0]) {
+        while (k < sz && !(arr[k - 1] < arr[k])) ++k;
+        if (k == sz) {
+            reverse(arr.begin(), arr.end());
+            return;
+        }
+    } else {
+        while (k < sz && !(arr[k] < arr[k - 1])) ++k;
+        if (k == sz)
+            return;
+    }
+
+    intro_sort_child(0, sz, arr, log2_floor(sz), true);
+}
+
+/**
+ * tasks submitted by one parallel phase, the phase waits only for its own tasks
+ */
+struct TaskGroup {
+    atomic<size_t> pending{0}; //tasks submitted but not finished
+};
+
+/**
+ * work-stealing task pool:
+ *  every thread owns a deque, it pushes and pops its own tasks at the back(LIFO, hot in cache)
+ *  an idle thread steals tasks from the front of the other deques(FIFO, the biggest tasks first)
+ *  the thread calling wait(group) executes tasks until the tasks of the group are finished,
+ *  it sleeps when there is nothing to steal, so independent sorts sharing the pool and waits
+ *  inside pool tasks don't block each other
+ */
+class TaskPool {
+public:
+    explicit TaskPool(unsigned num = thread::hardware_concurrency()) {
+        num = max(num, 1u);
+        for (unsigned i = 0; i <= num; ++i) //the last deque is shared by the external threads
+            queues.emplace_back(new TaskQueue);
+        for (unsigned i = 0; i != num; ++i)
+            threads.emplace_back([this, i] { work(i); });
+    }
+
+    ~TaskPool() {
+        {
+            lock_guard<mutex> lk(sleep_mtx);
+            stop = true;
+        }
+        sleep_cv.notify_all();
+        for (auto &t: threads)
+            t.join();
+    }
+
+    /**
+     * push a task into the deque of current thread
+     * @param group: group of the task
+     * @param task: the task to execute
+     * return: none
+     */
+    void submit(TaskGroup &group, function<void()> task) {
+        unsigned id = cur_pool == this ? cur_id : queues.size() - 1;
+        group.pending++;
+        {
+            lock_guard<mutex> lk(queues[id]->mtx);
+            queues[id]->tasks.push_back({&group, move(task)});
+        }
+        queued++;
+        {
+            lock_guard<mutex> lk(sleep_mtx); //no lost wake-up between predicate check and wait
+        }
+        sleep_cv.notify_one();
+        done_cv.notify_all(); //waiters with nothing to steal may help
+    }
+
+    /**
+     * help executing tasks until the tasks of the group are finished
+     * @param group: group to wait for
+     * return: none
+     */
+    void wait(TaskGroup &group) {
+        Task task;
+        unsigned id = cur_pool == this ? cur_id : queues.size() - 1;
+        while (group.pending > 0) {
+            if (pop_task(id, task)) {
+                run(task);
+                continue;
+            }
+            unique_lock<mutex> lk(sleep_mtx);
+            done_cv.wait(lk, [&] { return group.pending == 0 || queued > 0; });
+        }
+    }
+
+private:
+    struct Task {
+        TaskGroup *group;
+        function<void()> f;
+    };
+
+    struct TaskQueue {
+        mutex mtx;
+        deque<Task> tasks;
+    };
+
+    /**
+     * pop a task from the own deque, or steal one from the others
+     * @param id: index of the deque owned by current thread
+     * @param task: save the task popped
+     * return: true if a task was found
+     */
+    bool pop_task(unsigned id, Task &task) {
+        {
+            lock_guard<mutex> lk(queues[id]->mtx);
+            if (!queues[id]->tasks.empty()) {
+                task = move(queues[id]->tasks.back());
+                queues[id]->tasks.pop_back();
+                queued--;
+                return true;
+            }
+        }
+        for (unsigned k = 1; k != queues.size(); ++k) {
+            auto &victim = *queues[(id + k) % queues.size()];
+            lock_guard<mutex> lk(victim.mtx);
+            if (!victim.tasks.empty()) {
+                task = move(victim.tasks.front());
+                victim.tasks.pop_front();
+                queued--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run(Task &task) {
+        task.f();
+        task.f = nullptr;
+        if (--task.group->pending == 0) {
+            lock_guard<mutex> lk(sleep_mtx); //no lost wake-up of the waiter
+            done_cv.notify_all();
+        }
+    }
+
+    void work(unsigned id) {
+        cur_pool = this;
+        cur_id = id;
+        Task task;
+        while (true) {
+            if (pop_task(id, task)) {
+                run(task);
+                continue;
+            }
+            unique_lock<mutex> lk(sleep_mtx);
+            sleep_cv.wait(lk, [this] { return stop || queued > 0; });
+            if (stop) return;
+        }
+    }
+
+    vector<unique_ptr<TaskQueue>> queues;
+    vector<thread> threads;
+    atomic<size_t> queued{0};  //tasks waiting in the deques
+    bool stop = false;
+    mutex sleep_mtx;
+    condition_variable sleep_cv; //workers waiting for tasks
+    condition_variable done_cv;  //wait() callers waiting for their groups or for tasks
+
+    static thread_local TaskPool *cur_pool;
+    static thread_local unsigned cur_id;
+};
+
+thread_local TaskPool *TaskPool::cur_pool = nullptr;
+thread_local unsigned TaskPool::cur_id = 0;
+
+/**
+ * task pool shared by all parallel sorting algorithms, started on first use
+ */
+TaskPool &sort_pool() {
+    static TaskPool pool;
+    return pool;
+}
+
+const int PARALLEL_CUTOFF = 1 << 14; //partitions below this size are sorted serially
+
+/**
+ * hoare partition around the median of three elements
+ *  both parts are non-empty, so the recursion never reaches outside [i, j]
+ * @param i: pos of the left-most element
+ * @param j: pos of the right-most element
+ * @param arr: reference of the original vector
+ * return: pos p, that [i, p] <= pivot <= [p + 1, j]
+ */
+int hoare_partition(int i, int j, vector<int> &arr) {
+    int mid = i + (j - i) / 2;
+    if (arr[mid] < arr[i])
+        swap(i, mid, arr);
+    if (arr[j] < arr[i])
+        swap(i, j, arr);
+    if (arr[j] < arr[mid])
+        swap(mid, j, arr);
+    int pivot = arr[mid];
+
+    int left = i - 1, right = j + 1;
+    while (true) {
+        do left++; while (PERF_COUNT(COMPARISONS), arr[left] < pivot);
+        do right--; while (PERF_COUNT(COMPARISONS), arr[right] > pivot);
+        if (left >= right)
+            return right;
+        swap(left, right, arr);
+    }
+}
+
+/**
+ * parallel quick sort(not stable):
+ *  partitions larger than the cutoff are split and one half is forked onto the task pool,
+ *  partitions below the cutoff fall back to the serial intro_sort_child
+ *  time complexity: average-O(nlogn/p), worst-O(n^2)
+ *  space complexity: O(logn) - space for the pending tasks
+ * @param i: pos of the left-most element
+ * @param j: pos of the right-most element
+ * @param arr: reference of the original vector
+ * @param pool: task pool to fork the partitions onto
+ * @param group: group of the forked partitions
+ * return: none
+ */
+void parallel_quick_sort_child(int i, int j, vector<int> &arr, TaskPool &pool, TaskGroup &group) {
+    while (j - i >= PARALLEL_CUTOFF) {
+        int p = hoare_partition(i, j, arr);
+        //fork the smaller half, keep partitioning the larger one in this thread
+        if (p - i < j - p) {
+            pool.submit(group, [i, p, &arr, &pool, &group] { parallel_quick_sort_child(i, p, arr, pool, group); });
+            i = p + 1;
+        } else {
+            pool.submit(group, [p, j, &arr, &pool, &group] { parallel_quick_sort_child(p + 1, j, arr, pool, group); });
+            j = p;
+        }
+    }
+    //neighbour parts may be sorting in other threads, so never look before i
+    intro_sort_child(i, j + 1, arr, log2_floor(j - i + 1), true);
+}
+
+void parallel_quick_sort(vector<int> &arr) {
+    if (arr.size() <= PARALLEL_CUTOFF) {
+        intro_sort(arr);
+        return;
+    }
+
+    TaskPool &pool = sort_pool();
+    TaskGroup group;
+    pool.submit(group, [&arr, &pool, &group] { parallel_quick_sort_child(0, arr.size() - 1, arr, pool, group); });
+    pool.wait(group);
+}
+
 /**
  * insert sort(stable):
  *  optimize the algorithm by using binary search to find the position to insert element
  *  time complexity: average - O(nlogn) -- the original version is O(n^2), worst - O(n^2)
  *  space complexity: O(1)
+ * @param i: pos of the left-most element
+ * @param j: pos of the right-most element
+ * @param start: elements in [i, start) are already ordered
  * @param arr: reference of the original vector
  * return: none
  */
-void insert_sort(vector<int> &arr) {
-    int sz = arr.size();
-    for (int i = 1; i < sz; ++i)
-        if (arr[i] < arr[i - 1]) {
+void insert_sort_child(int i, int j, int start, vector<int> &arr) {
+    for (int k = max(start, i + 1); k <= j; ++k)
+        if (PERF_COUNT(COMPARISONS), arr[k] < arr[k - 1]) {
             //binary search, pay attention to the detail!
-            int tmp = arr[i];
-            int low = 0, high = i - 1, mid;
+            int tmp = arr[k];
+            int low = i, high = k - 1, mid;
             while (low <= high) //must be operator <=
             {
                 mid = (low + high) / 2;
+                PERF_COUNT(COMPARISONS);
                 if (tmp < arr[mid])
                     high = mid - 1;
                 else
                     low = mid + 1;
             }
 
-            for (int j = i; j != low; --j)
-                arr[j] = arr[j - 1];
+            for (int m = k; m != low; --m)
+                arr[m] = arr[m - 1];
             arr[low] = tmp;
+            PERF_ADD(MOVES, k - low + 1);
         }
 }
 
+void insert_sort(vector<int> &arr) {
+    insert_sort_child(0, static_cast<int>(arr.size()) - 1, 1, arr);
+}
+
 /**
  * shell_sort(not stable):
  *  time complexity: O(nlogn) - O(n^2)
@@ -163,8 +813,10 @@ void shell_sort(vector<int> &arr) {
     {
         for (int i = d; i != sz; ++i) {
             int j = i, tmp = arr[i];
-            for (; j >= d && tmp < arr[j - d]; j -= d)
+            for (; j >= d && (PERF_COUNT(COMPARISONS), tmp < arr[j - d]); j -= d) {
+                PERF_COUNT(MOVES);
                 arr[j] = arr[j - d];
+            }
             arr[j] = tmp;
         }
     }
@@ -183,11 +835,12 @@ void selection_sort(vector<int> &arr) {
         int min_pos = i;
         int min_value = arr[i];
         for (int j = i + 1; j != sz; ++j)
-            if (arr[j] < min_value) {
+            if (PERF_COUNT(COMPARISONS), arr[j] < min_value) {
                 min_pos = j;
                 min_value = arr[j];
             }
         if (min_pos != i) {
+            PERF_COUNT(SWAPS);
             arr[min_pos] = arr[i];
             arr[i] = min_value;
         }
@@ -196,45 +849,106 @@ void selection_sort(vector<int> &arr) {
 
 /**
  * heap sort(not stable):
- *  build max-heap to swap the head and tail elements until all elements be ordered
+ *  build max-heap in place on the original vector, swap the head and tail elements
+ *  until all elements be ordered
+ *  optimization_1: d-ary heap, children of pos are D*pos+1 .. D*pos+D, all D children are
+ *      compared in one or two cache lines, and the heap is log2(D) times shallower
+ *  optimization_2: bottom-up sift down(Floyd), the hole left by the head sinks to a leaf
+ *      along the larger children without comparing with the moved tail element,
+ *      then the tail element is sifted up from the leaf, it usually stays near the bottom
  *  time complexity: O(nlogn)
- *  space complexity: O(n) -- operating on the original vector can be O(1)
+ *  space complexity: O(1)
+ */
+
+/**
+ * push down the element at pos in the max-heap arr[begin, begin + sz)
+ * @param begin: pos of the heap root in the vector
+ * @param pos: pos of the element in the heap
+ * @param sz: number of elements in the heap
  * @param arr: reference of the original vector
- * return none
- */
-void push_down(int pos, int sz, vector<int> &arr) {
-    int tmp = arr[pos];
-    int next = 2 * pos - 1;
-    while (next <= sz) {
-        if (next + 1 <= sz && arr[next + 1] > arr[next])
-            next += 1;
-        if (arr[next] <= tmp) break;
-        arr[pos] = arr[next];
+ * return: none
+ */
+template<int D>
+void push_down(int begin, int pos, int sz, vector<int> &arr) {
+    int *heap = arr.data() + begin;
+    int tmp = heap[pos];
+    for (int child = D * pos + 1; child < sz; child = D * pos + 1) {
+        int next = child, last = min(child + D, sz);
+        for (int c = child + 1; c < last; ++c)
+            if (heap[c] > heap[next])
+                next = c;
+        PERF_ADD(COMPARISONS, last - child);
+        if (heap[next] <= tmp) break;
+        PERF_COUNT(MOVES);
+        heap[pos] = heap[next];
         pos = next;
-        next = 2 * next - 1;
     }
-    arr[pos] = tmp;
+    heap[pos] = tmp;
 }
 
-void heap_sort(vector<int> &arr) {
-    int sz = arr.size();
+/**
+ * put value into the hole at the root of the max-heap arr[begin, begin + sz), bottom-up
+ * return: none
+ */
+template<int D>
+void push_down_floyd(int begin, int sz, int value, vector<int> &arr) {
+    int *heap = arr.data() + begin;
+    int pos = 0;
+    for (int child = 1; child < sz; child = D * pos + 1) {
+        int next = child, last = min(child + D, sz);
+        for (int c = child + 1; c < last; ++c)
+            if (heap[c] > heap[next])
+                next = c;
+        PERF_ADD(COMPARISONS, last - child - 1);
+        PERF_COUNT(MOVES);
+        heap[pos] = heap[next];
+        pos = next;
+    }
+    while (pos > 0) {
+        int parent = (pos - 1) / D;
+        PERF_COUNT(COMPARISONS);
+        if (!(heap[parent] < value)) break;
+        PERF_COUNT(MOVES);
+        heap[pos] = heap[parent];
+        pos = parent;
+    }
+    heap[pos] = value;
+}
+
+/**
+ * @param begin: pos of the first element
+ * @param end: pos after the last element
+ * @param arr: reference of the original vector
+ * return: none
+ */
+template<int D>
+void heap_sort_d(int begin, int end, vector<int> &arr) {
+    int sz = end - begin;
+    if (sz < 2) return;
 
     //build max-heap
-    vector<int> heap(1);
-    for (const auto &item: arr)
-        heap.push_back(item);
-    for (int i = sz / 2; i >= 1; --i)
-        push_down(i, sz, heap);
+    for (int i = (sz - 2) / D; i >= 0; --i)
+        push_down<D>(begin, i, sz, arr);
 
-    //swap head and tail elements, adjust the heap
-    for (int i = sz; i >= 2; --i) {
-        swap(1, i, heap);
-        push_down(1, i - 1, heap);
+    //move the head to the tail, put the tail element into the heap again
+    for (int i = sz - 1; i >= 1; --i) {
+        int tmp = arr[begin + i];
+        arr[begin + i] = arr[begin];
+        push_down_floyd<D>(begin, i, tmp, arr);
     }
+}
+
+void heap_sort_range(int begin, int end, vector<int> &arr) {
+    heap_sort_d<4>(begin, end, arr);
+}
+
+void heap_sort(vector<int> &arr) {
+    heap_sort_d<4>(0, arr.size(), arr);
+}
 
-    //reverse and copy to the original vector
-    for (int i = 1; i != sz + 1; ++i)
-        arr[i - 1] = heap[i];
+template<int D>
+void heap_sort_dary(vector<int> &arr) {
+    heap_sort_d<D>(0, arr.size(), arr);
 }
 
 /**
@@ -255,8 +969,11 @@ void heap_sort(vector<int> &arr) {
  */
 void merge(int start, int mid, int end, vector<int> &arr_A, vector<int> &arr_B) {
     int i = start, j = mid + 1, k = start;
-    while (i <= mid && j <= end)
+    PERF_ADD(MOVES, end - start + 1);
+    while (i <= mid && j <= end) {
+        PERF_COUNT(COMPARISONS);
         arr_B[k++] = arr_A[i] <= arr_A[j] ? arr_A[i++] : arr_A[j++];
+    }
     while (i <= mid)
         arr_B[k++] = arr_A[i++];
     while (j <= end)
@@ -292,6 +1009,353 @@ void merge_sort_nrc(vector<int> &arr) {
     }
 }
 
+/**
+ * parallel merge sort(stable):
+ *  bottom-up like merge_sort_nrc, every pass is split into segments of the output
+ *  with equal length, one task per segment
+ *  early passes: a segment covers many whole pairs of runs
+ *  final passes: a segment is a slice of one huge merge, its start and end in both runs
+ *      are found by merge path(co-rank) binary search, so all cores share a single merge
+ *  time complexity: O(nlogn/p + logn*p*logn)
+ *  space complexity: O(n)
+ */
+const size_t MERGE_SEGMENT_MIN = 1 << 14; //shorter segments cost more in scheduling than merging
+
+/**
+ * co-rank of the k-th output position when merging a and b stably
+ * @param k: number of elements in the output prefix
+ * @param a: first sequence, taken first when equal
+ * @param la: length of a
+ * @param b: second sequence
+ * @param lb: length of b
+ * return: i, that the output prefix is a[0, i) and b[0, k - i)
+ */
+size_t co_rank(size_t k, const int *a, size_t la, const int *b, size_t lb) {
+    size_t low = k > lb ? k - lb : 0, high = min(k, la);
+    while (low < high) {
+        size_t i = low + (high - low) / 2, j = k - i;
+        if (j > 0 && i < la && !(b[j - 1] < a[i])) //a[i] must be output before b[j - 1]
+            low = i + 1;
+        else
+            high = i;
+    }
+    return low;
+}
+
+/**
+ * merge [a, a_end) and [b, b_end) into out, elements of a first when equal
+ * return: none
+ */
+void merge_range(const int *a, const int *a_end, const int *b, const int *b_end, int *out) {
+    while (a != a_end && b != b_end)
+        *out++ = *b < *a ? *b++ : *a++;
+    out = copy(a, a_end, out);
+    copy(b, b_end, out);
+}
+
+/**
+ * merge the part [low, high) of the output of one pass
+ * @param h: length of each sequence in src
+ * @param src: sequences to merge
+ * @param dst: output of the pass
+ * @param sz: number of elements
+ * return: none
+ */
+void merge_segment(size_t h, size_t low, size_t high, const int *src, int *dst, size_t sz) {
+    for (size_t base = low / (2 * h) * (2 * h); base < high; base += 2 * h) {
+        const int *a = src + base;
+        size_t la = min(h, sz - base), lb = min(h, sz - base - la);
+        const int *b = a + la;
+
+        //slice of this pair's output inside the segment
+        size_t k0 = max(low, base) - base, k1 = min(high, base + la + lb) - base;
+        size_t i0 = co_rank(k0, a, la, b, lb), i1 = co_rank(k1, a, la, b, lb);
+        merge_range(a + i0, a + i1, b + (k0 - i0), b + (k1 - i1), dst + base + k0);
+    }
+}
+
+void parallel_merge_sort(vector<int> &arr) {
+    size_t sz = arr.size();
+    TaskPool &pool = sort_pool();
+    TaskGroup group;
+    size_t tasks = min<size_t>(4 * max(thread::hardware_concurrency(), 1u), sz / MERGE_SEGMENT_MIN);
+    if (tasks < 2) {
+        merge_sort_nrc(arr);
+        return;
+    }
+
+    vector<int> dev(sz);
+    int *src = arr.data(), *dst = dev.data();
+    for (size_t h = 1; h < sz; h *= 2) {
+        for (size_t t = 0; t != tasks; ++t) {
+            size_t low = sz * t / tasks, high = sz * (t + 1) / tasks;
+            pool.submit(group, [=] { merge_segment(h, low, high, src, dst, sz); });
+        }
+        pool.wait(group);
+        swap(src, dst);
+    }
+
+    if (src != arr.data())
+        copy(src, src + sz, arr.data());
+}
+
+/**
+ * natural merge sort(stable), tim sort:
+ *  1.scan the ascending runs and strictly descending runs(reversed in place)
+ *  2.runs shorter than min_run are extended by binary insert sort
+ *  3.runs are pushed on a stack and merged when the lengths break the invariants
+ *      len[k-2] > len[k-1] + len[k] and len[k-1] > len[k], so merges stay balanced
+ *  4.merging galloping: when one run wins min_gallop times in a row, search the position of
+ *      the other run's head by exponential search and move the whole block at once,
+ *      merge_high searches backward from the ends of the runs, where its blocks are taken from
+ *  time complexity: O(n) on presorted input, O(nlogn) worst
+ *  space complexity: O(n)
+ * note: intervals here are [begin, end) like intro_sort
+ */
+class TimSort {
+public:
+    explicit TimSort(vector<int> &arr) : arr(arr) {}
+
+    void sort() {
+        int sz = arr.size();
+        if (sz < 2) return;
+
+        int min_run = min_run_length(sz);
+        for (int low = 0; low < sz;) {
+            int run = count_run(low, sz);
+            if (run < min_run) { //extend the short run
+                int force = min(min_run, sz - low);
+                insert_sort_child(low, low + force - 1, low + run, arr);
+                run = force;
+            }
+            runs.emplace_back(low, run);
+            merge_collapse();
+            low += run;
+        }
+        merge_force_collapse();
+    }
+
+private:
+    static const int MIN_MERGE = 64, MIN_GALLOP = 7;
+
+    /**
+     * minimum run length in [MIN_MERGE/2, MIN_MERGE], n/min_run is close to a power of 2
+     */
+    int min_run_length(int n) const {
+        int r = 0;
+        while (n >= MIN_MERGE) {
+            r |= n & 1;
+            n >>= 1;
+        }
+        return n + r;
+    }
+
+    /**
+     * length of the run starting at low, a strictly descending run is reversed
+     */
+    int count_run(int low, int high) {
+        int run_high = low + 1;
+        if (run_high == high) return 1;
+        if (arr[run_high++] < arr[low]) {
+            while (run_high < high && arr[run_high] < arr[run_high - 1]) ++run_high;
+            reverse(arr.begin() + low, arr.begin() + run_high);
+        } else {
+            while (run_high < high && !(arr[run_high] < arr[run_high - 1])) ++run_high;
+        }
+        return run_high - low;
+    }
+
+    void merge_collapse() {
+        while (runs.size() > 1) {
+            int k = runs.size() - 2;
+            if ((k > 0 && runs[k - 1].second <= runs[k].second + runs[k + 1].second)
+                || (k > 1 && runs[k - 2].second <= runs[k - 1].second + runs[k].second)) {
+                if (runs[k - 1].second < runs[k + 1].second) --k;
+            } else if (runs[k].second > runs[k + 1].second)
+                break; //invariants are established
+            merge_at(k);
+        }
+    }
+
+    void merge_force_collapse() {
+        while (runs.size() > 1) {
+            int k = runs.size() - 2;
+            if (k > 0 && runs[k - 1].second < runs[k + 1].second) --k;
+            merge_at(k);
+        }
+    }
+
+    /**
+     * first pos in [low, high) of a with a[pos] >= key, exponential search from low
+     */
+    static int gallop_left(int key, const int *a, int low, int high) {
+        int last = low, ofs = 0;
+        while (low + ofs < high && a[low + ofs] < key) {
+            last = low + ofs + 1;
+            ofs = ofs * 2 + 1;
+        }
+        return lower_bound(a + last, a + min(low + ofs, high), key) - a;
+    }
+
+    /**
+     * first pos in [low, high) of a with a[pos] > key, exponential search from low
+     */
+    static int gallop_right(int key, const int *a, int low, int high) {
+        int last = low, ofs = 0;
+        while (low + ofs < high && !(key < a[low + ofs])) {
+            last = low + ofs + 1;
+            ofs = ofs * 2 + 1;
+        }
+        return upper_bound(a + last, a + min(low + ofs, high), key) - a;
+    }
+
+    /**
+     * first pos in [low, high) of a with a[pos] >= key, exponential search from high
+     */
+    static int gallop_left_back(int key, const int *a, int low, int high) {
+        int last = high, ofs = 0;
+        while (high - 1 - ofs >= low && !(a[high - 1 - ofs] < key)) {
+            last = high - 1 - ofs;
+            ofs = ofs * 2 + 1;
+        }
+        return lower_bound(a + max(high - ofs, low), a + last, key) - a;
+    }
+
+    /**
+     * first pos in [low, high) of a with a[pos] > key, exponential search from high
+     */
+    static int gallop_right_back(int key, const int *a, int low, int high) {
+        int last = high, ofs = 0;
+        while (high - 1 - ofs >= low && key < a[high - 1 - ofs]) {
+            last = high - 1 - ofs;
+            ofs = ofs * 2 + 1;
+        }
+        return upper_bound(a + max(high - ofs, low), a + last, key) - a;
+    }
+
+    /**
+     * merge the k-th and (k+1)-th runs on the stack
+     */
+    void merge_at(int k) {
+        int base1 = runs[k].first, len1 = runs[k].second;
+        int base2 = runs[k + 1].first, len2 = runs[k + 1].second;
+        runs[k].second = len1 + len2;
+        runs.erase(runs.begin() + k + 1);
+
+        //elements of run1 before the head of run2 are in place
+        int skip = gallop_right(arr[base2], arr.data(), base1, base1 + len1) - base1;
+        base1 += skip;
+        len1 -= skip;
+        if (len1 == 0) return;
+
+        //elements of run2 after the tail of run1 are in place
+        len2 = gallop_left(arr[base1 + len1 - 1], arr.data(), base2, base2 + len2) - base2;
+        if (len2 == 0) return;
+
+        if (len1 <= len2)
+            merge_low(base1, len1, base2, len2);
+        else
+            merge_high(base1, len1, base2, len2);
+    }
+
+    /**
+     * merge from left to right, run1 is copied out as the shorter one
+     */
+    void merge_low(int base1, int len1, int base2, int len2) {
+        tmp.assign(arr.begin() + base1, arr.begin() + base1 + len1);
+        int c1 = 0, c2 = base2, end2 = base2 + len2, dest = base1;
+        while (c1 < len1 && c2 < end2) {
+            //one element at a time until a run wins min_gallop times in a row
+            int count1 = 0, count2 = 0;
+            while (c1 < len1 && c2 < end2) {
+                if (arr[c2] < tmp[c1]) {
+                    arr[dest++] = arr[c2++];
+                    count1 = 0;
+                    if (++count2 >= min_gallop) break;
+                } else {
+                    arr[dest++] = tmp[c1++];
+                    count2 = 0;
+                    if (++count1 >= min_gallop) break;
+                }
+            }
+
+            //galloping until both blocks are short
+            while (c1 < len1 && c2 < end2) {
+                count1 = gallop_right(arr[c2], tmp.data(), c1, len1) - c1;
+                copy(tmp.begin() + c1, tmp.begin() + c1 + count1, arr.begin() + dest);
+                dest += count1;
+                c1 += count1;
+                if (c1 == len1) break;
+
+                count2 = gallop_left(tmp[c1], arr.data(), c2, end2) - c2;
+                copy(arr.begin() + c2, arr.begin() + c2 + count2, arr.begin() + dest);
+                dest += count2;
+                c2 += count2;
+
+                if (count1 < MIN_GALLOP && count2 < MIN_GALLOP) {
+                    min_gallop++; //galloping doesn't pay, harder to enter next time
+                    break;
+                }
+                if (min_gallop > 1) min_gallop--;
+            }
+        }
+        copy(tmp.begin() + c1, tmp.begin() + len1, arr.begin() + dest);
+    }
+
+    /**
+     * merge from right to left, run2 is copied out as the shorter one
+     */
+    void merge_high(int base1, int len1, int base2, int len2) {
+        tmp.assign(arr.begin() + base2, arr.begin() + base2 + len2);
+        int c1 = base1 + len1 - 1, c2 = len2 - 1, dest = base2 + len2 - 1;
+        while (c1 >= base1 && c2 >= 0) {
+            int count1 = 0, count2 = 0;
+            while (c1 >= base1 && c2 >= 0) {
+                if (tmp[c2] < arr[c1]) {
+                    arr[dest--] = arr[c1--];
+                    count2 = 0;
+                    if (++count1 >= min_gallop) break;
+                } else {
+                    arr[dest--] = tmp[c2--];
+                    count1 = 0;
+                    if (++count2 >= min_gallop) break;
+                }
+            }
+
+            while (c1 >= base1 && c2 >= 0) {
+                int pos = gallop_right_back(tmp[c2], arr.data(), base1, c1 + 1);
+                count1 = c1 + 1 - pos;
+                copy_backward(arr.begin() + pos, arr.begin() + c1 + 1, arr.begin() + dest + 1);
+                dest -= count1;
+                c1 -= count1;
+                if (c1 < base1) break;
+
+                pos = gallop_left_back(arr[c1], tmp.data(), 0, c2 + 1);
+                count2 = c2 + 1 - pos;
+                copy_backward(tmp.begin() + pos, tmp.begin() + c2 + 1, arr.begin() + dest + 1);
+                dest -= count2;
+                c2 -= count2;
+
+                if (count1 < MIN_GALLOP && count2 < MIN_GALLOP) {
+                    min_gallop++;
+                    break;
+                }
+                if (min_gallop > 1) min_gallop--;
+            }
+        }
+        copy_backward(tmp.begin(), tmp.begin() + c2 + 1, arr.begin() + dest + 1);
+    }
+
+    vector<int> &arr;
+    vector<int> tmp;                //copy of the shorter run while merging
+    vector<pair<int, int>> runs;    //stack of runs: (base, length)
+    int min_gallop = MIN_GALLOP;
+};
+
+void tim_sort(vector<int> &arr) {
+    TimSort(arr).sort();
+}
+
 /**
  * merge sort:
  *  from top to the bottm, recursively
@@ -324,35 +1388,93 @@ void merge_sort_rc(vector<int> &arr) {
 }
 
 /**
- * counting sort(stable):
- *  time complexity: O(k + n)
- *  space complexity: O(k + n)
+ * counting sort:
+ *  scan the minimum and maximum, count elements by the offset to the minimum,
+ *  so negative elements and ranges far from zero need no extra space
+ *  counts are 32-bit while the size fits, the histograms of all threads and the start
+ *  positions take at most 1/COUNTING_MAX_SPACE_RATIO of the elements' bytes, fewer threads
+ *  are used when they don't fit, and when even one histogram doesn't fit a range larger than
+ *  COUNTING_MAX_DENSE_RANGE falls back to radix sort
+ *  every thread counts its own chunk into a local histogram, local histograms are merged
+ *  by prefix sum into the start position of every key, then the threads write the output
+ *  chunks in parallel with the keys covering them
+ *  elements are plain ints, so writing the keys by their counts is the same as moving them stably
+ *  time complexity: O(n/p + k*p)
+ *  space complexity: O(k*p)
  * @param arr: reference of the original vector
  * return: none
  */
-void counting_sort(vector<int> &arr) {
-    if (arr.empty()) return;
-    int sz = arr.size();
+const size_t COUNTING_MAX_DENSE_RANGE = 1 << 16; //ranges below it always use counting
+const size_t COUNTING_CHUNK_MIN = 1 << 16;       //elements per thread
+const size_t COUNTING_MAX_SPACE_RATIO = 2;       //histograms take at most 1/2 of the elements' bytes
+
+void radix_sort_lsd(vector<int> &arr);
+
+/**
+ * counting sort of arr in [min, min + range) by threads histograms of count type C
+ */
+template<typename C>
+void counting_sort_child(vector<int> &arr, int min, size_t range, size_t threads) {
+    size_t sz = arr.size();
+    TaskPool &pool = sort_pool();
+    TaskGroup group;
+
+    //counting number, count[t * range + key] for chunk t
+    vector<C> count(threads * range, 0);
+    for (size_t t = 0; t != threads; ++t)
+        pool.submit(group, [&, t] {
+            C *cnt = &count[t * range];
+            for (size_t i = sz * t / threads, end = sz * (t + 1) / threads; i != end; ++i)
+                cnt[arr[i] - min]++;
+        });
+    pool.wait(group);
+
+    //merge histograms into the start position of every key
+    vector<C> start(range + 1, 0);
+    for (size_t key = 0; key != range; ++key) {
+        C total = 0;
+        for (size_t t = 0; t != threads; ++t)
+            total += count[t * range + key];
+        start[key + 1] = start[key] + total;
+    }
+    vector<C>().swap(count);
+
+    //write keys to the correct position, every thread fills one chunk of the output
+    for (size_t t = 0; t != threads; ++t)
+        pool.submit(group, [&, t] {
+            size_t i = sz * t / threads, end = sz * (t + 1) / threads;
+            size_t key = upper_bound(start.begin(), start.end(), i) - start.begin() - 1;
+            for (; i != end; ++key) {
+                size_t stop = std::min<size_t>(start[key + 1], end);
+                fill(arr.begin() + i, arr.begin() + stop, static_cast<int>(min + static_cast<long long>(key)));
+                i = stop;
+            }
+        });
+    pool.wait(group);
+}
 
-    //find the maximum element;
-    int max = arr[0];
-    for (const auto &item: arr)
-        if (item > max)
-            max = item;
+void counting_sort(vector<int> &arr) {
+    size_t sz = arr.size();
+    if (sz < 2) return;
 
-    //counting number
-    vector<int> count(max + 1, 0);
-    vector<int> dev(sz + 1, 0);
-    for (const auto &item: arr)
-        count[item]++;
-    for (int i = 1; i <= max; ++i)
-        count[i] += count[i - 1];
+    //find the minimum and maximum elements
+    auto bounds = minmax_element(arr.begin(), arr.end());
+    int min = *bounds.first;
+    size_t range = static_cast<size_t>(static_cast<long long>(*bounds.second) - min) + 1;
 
-    //copy elements to the correct position
-    for (int i = sz - 1; i >= 0; --i) //to keep stability at reversed order
-        dev[count[arr[i]]--] = arr[i];
-    for (int i = 0; i != sz; ++i)
-        arr[i] = dev[i + 1];
+    //threads + 1 arrays of range counts(histograms and start positions) within the space budget
+    bool narrow = sz <= UINT32_MAX;
+    size_t budget = sz * sizeof(int) / COUNTING_MAX_SPACE_RATIO / (range * (narrow ? sizeof(uint32_t) : sizeof(size_t)));
+    if (budget < 2 && range > COUNTING_MAX_DENSE_RANGE) {
+        radix_sort_lsd(arr);
+        return;
+    }
+    size_t threads = std::min<size_t>(max(thread::hardware_concurrency(), 1u), sz / COUNTING_CHUNK_MIN);
+    threads = std::max<size_t>(std::min(threads, budget - (budget != 0)), 1);
+    if (narrow)
+        counting_sort_child<uint32_t>(arr, min, range, threads);
+    else
+        counting_sort_child<size_t>(arr, min, range, threads);
 }
 
 /**
@@ -362,122 +1484,467 @@ void counting_sort(vector<int> &arr) {
  */
 
 /**
- * extract value at given postion
- * @param value: the element
- * @param pos: position of the value to extract
+ * radix sort:
+ *  least significant digit first, using 8-bit digits of the full 32-bit key
+ *  the sign bit is flipped so that negative elements are ordered before positive ones
+ *  histograms of all digits are counted in a single pass over the elements
+ *  passes ping-pong between the original vector and one scratch buffer,
+ *  a pass is skipped when all elements share the same digit
+ *  time complexity: O(4*(n+256))
+ *  space complexity: O(n)
+ * @param arr: reference of the original vector
  * return: none
  */
-int radix(int value, int pos) {
-    auto power = static_cast<int>(pow(10, pos - 1));
-    return value / power % 10;
+void radix_sort_lsd(vector<int> &arr) {
+    const int BITS = 8, BUCKETS = 1 << BITS, PASSES = 32 / BITS;
+    const uint32_t MASK = BUCKETS - 1, SIGN = 0x80000000u;
+    size_t sz = arr.size();
+    if (sz < 2) return;
+
+    //counting all digits in a single pass
+    vector<size_t> count(PASSES * BUCKETS, 0);
+    for (const auto &elem: arr) {
+        uint32_t key = static_cast<uint32_t>(elem) ^ SIGN;
+        for (int pass = 0; pass != PASSES; ++pass)
+            count[pass * BUCKETS + (key >> (pass * BITS) & MASK)]++;
+    }
+
+    vector<int> dev(sz);
+    int *src = arr.data(), *dst = dev.data();
+    for (int pass = 0; pass != PASSES; ++pass) {
+        int shift = pass * BITS;
+        size_t *cnt = &count[pass * BUCKETS];
+
+        //all elements share the same digit, nothing to move
+        uint32_t digit = (static_cast<uint32_t>(src[0]) ^ SIGN) >> shift & MASK;
+        if (cnt[digit] == sz)
+            continue;
+
+        //turn the counts into start positions of the buckets
+        size_t sum = 0;
+        for (int r = 0; r != BUCKETS; ++r) {
+            size_t tmp = cnt[r];
+            cnt[r] = sum;
+            sum += tmp;
+        }
+
+        //scatter elements to the correct position, keep stability
+        for (size_t i = 0; i != sz; ++i) {
+            uint32_t key = static_cast<uint32_t>(src[i]) ^ SIGN;
+            dst[cnt[key >> shift & MASK]++] = src[i];
+        }
+        swap(src, dst);
+    }
+
+    if (src != arr.data())
+        copy(src, src + sz, arr.data());
 }
 
 /**
- * radix sort:
- *  using buckect allocation as the stable sort algorithm
+ * bucket sort(not stable), sample sort:
+ *  1.choose up to BUCKETS-1 splitters from a random sample, so buckets get nearly equal sizes
+ *    whatever the distribution and range of the elements are, equal splitters are merged
+ *  2.classify every element by a search tree of the splitters in implicit layout(root 1,
+ *    children 2j and 2j+1), descending the tree is j = 2j + (splitter < x), without branches
+ *  3.every splitter has an equality bucket next to the bucket it bounds, the elements equal
+ *    to it go there by one more comparison, so duplicated keys don't pile into one bucket
+ *  4.count the bucket sizes, then scatter elements into one contiguous buffer
+ *  5.sort the buckets in parallel on the task pool, equality buckets are already sorted
+ *  classification and scattering are done by chunks in parallel, with local counts per chunk
+ *  time complexity: average-O(nlogn/p), O(n) passes of data movement
+ *  space complexity: O(n)
  * @param arr: reference of the original vector
- * @param width: max bit width of all elements
  * return: none
  */
-void radix_sort_child_1(vector<int> &arr, int width) {
-    queue<int> A;
-    for (const auto &elem: arr)
-        A.push(elem);
-
-    //using bucket allocation as the statble sort algorithm
-    for (int pass = 1; pass <= width; ++pass) {
-        //allocate elements into buckets
-        vector<queue<int>> buckets(10);
-        while (!A.empty()) {
-            int elem = A.front();
-            A.pop();
-            int r = radix(elem, pass);
-            buckets[r].push(elem);
-        }
-
-        //collect elements from buckets
-        for (auto &bucket: buckets)
-            while (!bucket.empty()) {
-                A.push(bucket.front());
-                bucket.pop();
+const int SAMPLE_LOG_BUCKETS = 8, SAMPLE_BUCKETS = 1 << SAMPLE_LOG_BUCKETS;
+const int SAMPLE_OVERSAMPLING = 16;        //sample elements per bucket
+const size_t SAMPLE_SORT_MIN = 1 << 14;    //smaller vectors are sorted by intro sort directly
+
+/**
+ * fill the splitter tree in order of the sorted splitters
+ * @param leaves: number of buckets of the tree, inner nodes are in [1, leaves)
+ * return: none
+ */
+void build_splitter_tree(int node, int leaves, const vector<int> &splitters, int &next, vector<int> &tree) {
+    if (node >= leaves) return;
+    build_splitter_tree(2 * node, leaves, splitters, next, tree);
+    tree[node] = splitters[next++];
+    build_splitter_tree(2 * node + 1, leaves, splitters, next, tree);
+}
+
+void bucket_sort(vector<int> &arr) {
+    size_t sz = arr.size();
+    if (sz < SAMPLE_SORT_MIN) {
+        intro_sort(arr);
+        return;
+    }
+
+    //choose distinct splitters from a random sample
+    mt19937 gen(static_cast<unsigned>(sz));
+    uniform_int_distribution<size_t> uni(0, sz - 1);
+    vector<int> sample(SAMPLE_BUCKETS * SAMPLE_OVERSAMPLING);
+    for (auto &item: sample)
+        item = arr[uni(gen)];
+    intro_sort(sample);
+    vector<int> splitters;
+    for (int i = 0; i != SAMPLE_BUCKETS - 1; ++i)
+        if (splitters.empty() || splitters.back() != sample[(i + 1) * SAMPLE_OVERSAMPLING])
+            splitters.push_back(sample[(i + 1) * SAMPLE_OVERSAMPLING]);
+
+    //the smallest tree holding the splitters, padded by the largest one
+    //no element is above one copy of the largest splitter and below the next, padded buckets stay empty
+    int log_buckets = 1;
+    while ((1 << log_buckets) <= static_cast<int>(splitters.size())) ++log_buckets;
+    int buckets = 1 << log_buckets, slots = 2 * buckets; //a normal and an equality bucket each
+    splitters.resize(buckets, splitters.back());
+    vector<int> tree(buckets);
+    int next = 0;
+    build_splitter_tree(1, buckets, splitters, next, tree);
+
+    //classify elements and count bucket sizes of every chunk
+    size_t chunks = std::min<size_t>(max(thread::hardware_concurrency(), 1u), sz / SAMPLE_SORT_MIN);
+    vector<uint16_t> oracle(sz);
+    vector<size_t> count(chunks * slots, 0);
+    TaskPool &pool = sort_pool();
+    TaskGroup group;
+    for (size_t t = 0; t != chunks; ++t)
+        pool.submit(group, [&, t] {
+            size_t *cnt = &count[t * slots];
+            for (size_t i = sz * t / chunks, end = sz * (t + 1) / chunks; i != end; ++i) {
+                int x = arr[i];
+                unsigned j = 1;
+                for (int level = 0; level != log_buckets; ++level)
+                    j = 2 * j + (tree[j] < x);
+                j -= buckets;
+                j = 2 * j + (splitters[j] == x);
+                oracle[i] = static_cast<uint16_t>(j);
+                cnt[j]++;
             }
+        });
+    pool.wait(group);
+
+    //start positions of every bucket in every chunk, bucket major
+    vector<size_t> bucket_start(slots + 1, 0);
+    size_t sum = 0;
+    for (int b = 0; b != slots; ++b) {
+        bucket_start[b] = sum;
+        for (size_t t = 0; t != chunks; ++t) {
+            size_t tmp = count[t * slots + b];
+            count[t * slots + b] = sum;
+            sum += tmp;
+        }
     }
+    bucket_start[slots] = sz;
+
+    //scatter elements into the buffer
+    vector<int> dev(sz);
+    for (size_t t = 0; t != chunks; ++t)
+        pool.submit(group, [&, t] {
+            size_t *cnt = &count[t * slots];
+            for (size_t i = sz * t / chunks, end = sz * (t + 1) / chunks; i != end; ++i)
+                dev[cnt[oracle[i]]++] = arr[i];
+        });
+    pool.wait(group);
 
-    for (int i = 0; i != arr.size(); ++i) {
-        arr[i] = A.front();
-        A.pop();
+    //sort every bucket and copy it back, equality buckets are only copied
+    for (int b = 0; b != slots; ++b) {
+        int begin = bucket_start[b], end = bucket_start[b + 1];
+        if (begin == end) continue;
+        bool equal = b & 1;
+        pool.submit(group, [&, begin, end, equal] {
+            if (!equal)
+                intro_sort_child(begin, end, dev, log2_floor(end - begin) + 1, true);
+            copy(dev.begin() + begin, dev.begin() + end, arr.begin() + begin);
+        });
     }
+    pool.wait(group);
 }
 
-void radix_sort_1(vector<int> &arr) {
-    radix_sort_child_1(arr, 2);
-}
+/**
+ * external merge sort:
+ *  sort a binary file of ints which is larger than the memory
+ *  1.run generation: read chunks that fit in the memory budget, sort every chunk by
+ *    merge_sort_nrc(it needs an equal sized buffer, so a chunk takes half of the budget),
+ *    spill the sorted run to a temporary file by one sequential write
+ *  2.k-way merge: merge the runs by a loser tree, every run is read by two blocks in turn,
+ *    the next block is read by one I/O thread of the pass while the current block is merged
+ *    if the budget can't hold two blocks for every run, merge groups of runs into longer
+ *    runs first, a single run is renamed to the output without merging
+ *  I/O volume: 2*n*(1+passes) ints
+ */
+const size_t EXTERNAL_MIN_BLOCK = 1 << 12; //ints per block, smaller blocks make the reads random
+
+struct ExternalSortStats {
+    size_t bytes_read = 0;
+    size_t bytes_written = 0;
+    size_t runs = 0;         //number of runs generated
+    size_t merge_passes = 0;
+    double run_seconds = 0;  //time of run generation
+    double merge_seconds = 0;//time of all merge passes
+};
 
 /**
- * radix sort:
- *  using counting sort as the stable sort algorithm
- * @param arr: reference of the original vector
- * @param width: max bit width of all elements
- * return: none
+ * temporary run files, removed when the sort returns, whether it succeeded or not
  */
-void radix_sort_child_2(vector<int> &arr, int width) {
-    if (arr.empty()) return;
-    int sz = arr.size();
+class TempFiles {
+public:
+    TempFiles() = default;
 
-    //using counting sort as the stable sort algorithm
-    for (int pass = 1; pass <= width; ++pass) {
-        vector<int> comp(sz, 0);
-        for (int i = 0; i != sz; ++i)
-            comp[i] = radix(arr[i], pass);
+    TempFiles(const TempFiles &) = delete;
 
-        //find the maximum element
-        int max = comp[0];
-        for (const auto &elem: comp)
-            if (elem > max)
-                max = elem;
+    TempFiles &operator=(const TempFiles &) = delete;
 
-        //counting number
-        vector<int> dev(sz + 1, 0);
-        vector<int> count(max + 1, 0);
-        for (const auto &elem: comp)
-            count[elem]++;
-        for (int i = 1; i <= max; ++i)
-            count[i] += count[i - 1];
+    ~TempFiles() {
+        for (const auto &path: paths)
+            remove(path.c_str());
+    }
 
-        //copy elements to the correct position
-        for (int i = sz - 1; i >= 0; --i)
-            dev[count[comp[i]]--] = arr[i];
-        for (int i = 0; i != sz; ++i)
-            arr[i] = dev[i + 1];
+    const string &add(string path) {
+        paths.push_back(move(path));
+        return paths.back();
     }
-}
 
-void radix_sort_2(vector<int> &arr) {
-    radix_sort_child_2(arr, 2);
+private:
+    vector<string> paths;
+};
+
+/**
+ * one background thread doing the block reads of a merge pass in order of submission
+ *  the destructor finishes the queued reads before joining
+ */
+class IOThread {
+public:
+    IOThread() : worker([this] { work(); }) {}
+
+    ~IOThread() {
+        {
+            lock_guard<mutex> lk(mtx);
+            stop = true;
+        }
+        cv.notify_one();
+        worker.join();
+    }
+
+    future<size_t> submit(function<size_t()> read) {
+        packaged_task<size_t()> task(move(read));
+        auto result = task.get_future();
+        {
+            lock_guard<mutex> lk(mtx);
+            tasks.push_back(move(task));
+        }
+        cv.notify_one();
+        return result;
+    }
+
+private:
+    void work() {
+        while (true) {
+            packaged_task<size_t()> task;
+            {
+                unique_lock<mutex> lk(mtx);
+                cv.wait(lk, [this] { return stop || !tasks.empty(); });
+                if (tasks.empty()) return;
+                task = move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    mutex mtx;
+    condition_variable cv;
+    deque<packaged_task<size_t()>> tasks;
+    bool stop = false;
+    thread worker; //started last, after the members it uses
+};
+
+/**
+ * sequential reader of a run, holding two blocks
+ *  the block being merged and the block being read by the I/O thread
+ *  a reader has at most one read in flight, so its byte count is only touched by one
+ *  thread at a time
+ */
+class RunReader {
+public:
+    RunReader(const string &path, size_t block, IOThread &io)
+            : in(path, ios::binary), block(block), io(io) {
+        buf[0].resize(block);
+        buf[1].resize(block);
+        len = read_block(buf[0]);
+        fetch();
+    }
+
+    bool is_open() const { return in.is_open(); }
+
+    /**
+     * bytes read from the run, after the read in flight is finished
+     */
+    size_t bytes() {
+        if (pending.valid())
+            pending.wait();
+        return bytes_read;
+    }
+
+    /**
+     * get the next element of the run
+     * @param value: save the element
+     * return: false if the run is exhausted
+     */
+    bool next(int &value) {
+        if (pos == len) {
+            if (len < block)      //the last block was not full
+                return false;
+            len = pending.get();  //wait for the block read in the background
+            if (len == 0)
+                return false;
+            cur ^= 1;
+            pos = 0;
+            fetch();
+        }
+        value = buf[cur][pos++];
+        return true;
+    }
+
+private:
+    size_t read_block(vector<int> &b) {
+        in.read(reinterpret_cast<char *>(b.data()), b.size() * sizeof(int));
+        auto bytes = static_cast<size_t>(in.gcount());
+        bytes_read += bytes;
+        return bytes / sizeof(int);
+    }
+
+    void fetch() {
+        if (len < block) return;
+        vector<int> &b = buf[cur ^ 1];
+        pending = io.submit([this, &b] { return read_block(b); });
+    }
+
+    ifstream in;
+    size_t block;
+    IOThread &io;
+    vector<int> buf[2];
+    int cur = 0;
+    size_t pos = 0, len = 0;
+    size_t bytes_read = 0;
+    future<size_t> pending;
+};
+
+/**
+ * merge the runs into one file by a loser tree
+ * @param inputs: files of the sorted runs
+ * @param output: file of the merged run
+ * @param block: ints per block
+ * @param stats: I/O statistics
+ * return: false if any file can't be opened
+ */
+bool merge_runs(const vector<string> &inputs, const string &output, size_t block, ExternalSortStats &stats) {
+    vector<unique_ptr<RunReader>> readers;
+    IOThread io; //destroyed before the readers, so no read outlives its buffer
+    for (const auto &path: inputs) {
+        readers.emplace_back(new RunReader(path, block, io));
+        if (!readers.back()->is_open())
+            return false;
+    }
+    ofstream out(output, ios::binary);
+    if (!out) return false;
+
+    algo::LoserTree<int> tree(readers.size());
+    int value;
+    for (size_t i = 0; i != readers.size(); ++i)
+        if (readers[i]->next(value))
+            tree.set(i, value);
+    tree.build();
+
+    vector<int> dev;
+    dev.reserve(block);
+    while (!tree.empty()) {
+        dev.push_back(tree.top_key());
+        if (readers[tree.top()]->next(value))
+            tree.replace(value);
+        else
+            tree.pop();
+
+        if (dev.size() == block || tree.empty()) {
+            out.write(reinterpret_cast<const char *>(dev.data()), dev.size() * sizeof(int));
+            stats.bytes_written += dev.size() * sizeof(int);
+            dev.clear();
+        }
+    }
+    for (auto &reader: readers)
+        stats.bytes_read += reader->bytes();
+    return static_cast<bool>(out);
 }
 
 /**
- * bucket sort(stable):
- *  time complexity: O(n)
- *  space complexity: O(n)
- * @param arr: reference of the original vector
- * return: none
+ * @param input: binary file of ints to sort
+ * @param output: binary file to save the sorted ints
+ * @param memory: memory budget in bytes
+ * @param stats: I/O volume and phase timings
+ * return: false if any file can't be opened
  */
-void bucket_sort(vector<int> &arr) {
-    //allocate elements into buckets by certain rule
-    vector<vector<int>> buckets(20);
-    for (const auto &elem: arr)
-        buckets[elem / 5].push_back(elem);
+bool external_sort(const string &input, const string &output, size_t memory, ExternalSortStats &stats) {
+    using clock = chrono::steady_clock;
+    stats = ExternalSortStats();
+    ifstream in(input, ios::binary);
+    if (!in) return false;
 
-    //do insert_sort for each bucket
-    for (auto &bucket: buckets)
-        insert_sort(bucket);
+    //generate sorted runs
+    auto start = clock::now();
+    size_t chunk = max(memory / (2 * sizeof(int)), EXTERNAL_MIN_BLOCK);
+    TempFiles temp;
+    vector<string> runs;
+    vector<int> arr(chunk);
+    while (true) {
+        arr.resize(chunk);
+        in.read(reinterpret_cast<char *>(arr.data()), chunk * sizeof(int));
+        auto count = static_cast<size_t>(in.gcount()) / sizeof(int);
+        stats.bytes_read += static_cast<size_t>(in.gcount());
+        if (count == 0) break;
 
-    //collect elements from buckets
-    arr.clear();
-    for (const auto &bucket: buckets)
-        for (const auto &elem: bucket)
-            arr.push_back(elem);
+        arr.resize(count);
+        merge_sort_nrc(arr);
+        runs.push_back(temp.add(output + ".run" + to_string(runs.size())));
+        ofstream out(runs.back(), ios::binary);
+        if (!out) return false;
+        out.write(reinterpret_cast<const char *>(arr.data()), count * sizeof(int));
+        stats.bytes_written += count * sizeof(int);
+        if (count < chunk) break;
+    }
+    vector<int>().swap(arr); //release the memory before merging
+    stats.runs = runs.size();
+    stats.run_seconds = chrono::duration<double>(clock::now() - start).count();
+
+    //merge runs, more passes if the budget can't hold two blocks for every run
+    start = clock::now();
+    if (runs.empty())
+        return static_cast<bool>(ofstream(output, ios::binary));
+    if (runs.size() == 1) {
+        remove(output.c_str());
+        return rename(runs[0].c_str(), output.c_str()) == 0;
+    }
+    size_t fan_in = max<size_t>(2, memory / ((2 * EXTERNAL_MIN_BLOCK + EXTERNAL_MIN_BLOCK) * sizeof(int)));
+    size_t next_id = runs.size();
+    do {
+        vector<string> merged;
+        for (size_t i = 0; i < runs.size(); i += fan_in) {
+            vector<string> group(runs.begin() + i, runs.begin() + min(i + fan_in, runs.size()));
+            if (group.size() == 1) { //a run left alone goes to the next pass as it is
+                merged.push_back(group[0]);
+                continue;
+            }
+            string target = runs.size() <= fan_in ? output : temp.add(output + ".run" + to_string(next_id++));
+            size_t block = max(memory / ((2 * group.size() + 1) * sizeof(int)), EXTERNAL_MIN_BLOCK);
+            if (!merge_runs(group, target, block, stats))
+                return false;
+            for (const auto &path: group)
+                remove(path.c_str());
+            merged.push_back(target);
+        }
+        runs.swap(merged);
+        stats.merge_passes++;
+    } while (runs.size() > 1);
+    stats.merge_seconds = chrono::duration<double>(clock::now() - start).count();
+    return true;
 }
 
 /**
@@ -503,19 +1970,415 @@ void test_sort(TF *sort) {
     }
 }
 
-int main() {
+/**
+ * test function for the generic sorting algorithms in sort.h
+ *  sort records by key in place, and sort a slice of a bigger buffer
+ */
+void test_generic_sort() {
+    struct Record {
+        string name;
+        double score;
+    };
+    vector<Record> records{{"a", 3.5}, {"b", -1.25}, {"c", 2.0}, {"d", -1.25}, {"e", 0.0}};
+    auto score = [](const Record &r) { return r.score; };
+
+    algo::sort_by_key(records.begin(), records.end(), score); //floating key, radix sort
+    for (const auto &r: records)
+        cout << r.name << ":" << r.score << " ";
+    cout << endl;
+
+    algo::merge_sort_nrc(records.begin(), records.end(), algo::by_key([](const Record &r) { return r.name; }));
+    for (const auto &r: records)
+        cout << r.name << ":" << r.score << " ";
+    cout << endl;
+
+    vector<int64_t> buffer{9, 8, 7, 6, 5, 4, 3, 2, 1, 0};
+    algo::heap_sort(buffer.begin() + 2, buffer.begin() + 8);
+    for (const auto &item: buffer)
+        cout << item << " ";
+    cout << endl;
+
+    vector<int> arr{5, 1, 9, 3, 7, 3, 8, 2, 6, 4};
+    algo::nth_element(arr.begin(), arr.begin() + arr.size() / 2, arr.end());
+    cout << "median: " << arr[arr.size() / 2] << endl;
+    algo::partial_sort(arr.begin(), arr.begin() + 3, arr.end());
+    cout << "smallest 3: " << arr[0] << " " << arr[1] << " " << arr[2] << endl;
+    istringstream stream("12 45 7 33 90 18 64");
+    auto largest = algo::top_k(istream_iterator<int>(stream), istream_iterator<int>(), 3, greater<>());
+    cout << "largest 3: " << largest[0] << " " << largest[1] << " " << largest[2] << endl;
+
+    vector<string> names{"e", "d", "c", "b", "a"};
+    vector<double> scores{0.0, -1.25, 2.0, -1.25, 3.5};
+    auto perm = algo::argsort(scores.begin(), scores.end());
+    algo::apply_permutation(names.begin(), perm); //reorder another column by the scores
+    for (const auto &name: names)
+        cout << name << " ";
+    cout << endl;
+    vector<int> ids{0, 1, 2, 3, 4};
+    algo::sort_pairs(scores.begin(), scores.end(), ids.begin());
+    for (size_t i = 0; i != scores.size(); ++i)
+        cout << ids[i] << ":" << scores[i] << " ";
+    cout << endl;
+}
+
+/**
+ * test function for k-way merge
+ *  merge k sorted shards of (key, shard) pairs sequentially, in parallel and as streams,
+ *  equal keys must keep the order of shards
+ * @param k: number of shards
+ * @param n: elements per shard
+ */
+void test_multiway_merge(size_t k = 256, size_t n = 1 << 12) {
+    using Item = pair<int, size_t>;
+    auto key_less = [](const Item &a, const Item &b) { return a.first < b.first; };
+    mt19937 gen(2018);
+    vector<vector<Item>> shards(k);
+    vector<pair<vector<Item>::const_iterator, vector<Item>::const_iterator>> spans;
+    vector<Item> expected;
+    for (size_t i = 0; i != k; ++i) {
+        for (size_t j = gen() % (2 * n); j != 0; --j)
+            shards[i].emplace_back(gen() % 1000, i);
+        sort(shards[i].begin(), shards[i].end());
+        spans.emplace_back(shards[i].cbegin(), shards[i].cend());
+        expected.insert(expected.end(), shards[i].begin(), shards[i].end());
+    }
+    stable_sort(expected.begin(), expected.end(), key_less);
+
+    vector<Item> res;
+    algo::multiway_merge(spans, back_inserter(res), key_less);
+    cout << "multiway merge: " << (res == expected ? "sorted" : "wrong") << endl;
+
+    res.assign(expected.size(), Item());
+    algo::parallel_multiway_merge(spans, res.begin(), max(thread::hardware_concurrency(), 4u), key_less);
+    cout << "parallel multiway merge: " << (res == expected ? "sorted" : "wrong") << endl;
+
+    vector<function<bool(Item &)>> sources;
+    for (const auto &shard: shards)
+        sources.emplace_back([&shard, pos = size_t(0)](Item &value) mutable {
+            if (pos == shard.size()) return false;
+            value = shard[pos++];
+            return true;
+        });
+    res.clear();
+    algo::multiway_merge_stream<Item>(sources, back_inserter(res), key_less);
+    cout << "multiway merge of streams: " << (res == expected ? "sorted" : "wrong") << endl;
+}
+
+/**
+ * test function for external merge sort
+ *  write random ints to a file, sort it with a small memory budget, check the result
+ * @param n: number of ints
+ * @param memory: memory budget in bytes
+ */
+void test_external_sort(size_t n = 1 << 22, size_t memory = 1 << 20) {
+    string input = "external_input.bin", output = "external_output.bin";
+    mt19937 gen(2018);
+    vector<int> arr(n);
+    for (auto &item: arr)
+        item = static_cast<int>(gen());
+    ofstream(input, ios::binary).write(reinterpret_cast<const char *>(arr.data()), n * sizeof(int));
+
+    ExternalSortStats stats;
+    if (!external_sort(input, output, memory, stats)) {
+        cout << "external sort failed." << endl;
+        return;
+    }
+
+    vector<int> res(n);
+    ifstream(output, ios::binary).read(reinterpret_cast<char *>(res.data()), n * sizeof(int));
+    sort(arr.begin(), arr.end());
+    cout << (arr == res ? "sorted" : "wrong") << ": runs " << stats.runs << ", merge passes " << stats.merge_passes
+         << ", read " << stats.bytes_read << " bytes, written " << stats.bytes_written << " bytes, run phase "
+         << stats.run_seconds << "s, merge phase " << stats.merge_seconds << "s" << endl;
+    remove(input.c_str());
+    remove(output.c_str());
+}
+
+/**
+ * benchmark for sorting algorithms:
+ *  run every algorithm on every size and distribution, warmup runs first, then repeated runs
+ *  every run sorts a fresh copy of the input and is checked against std::sort
+ *  report the median time and elements per second as csv or json
+ */
+struct SortAlgorithm {
+    string name;
+    TF *sort;
+    size_t max_size; //O(n^2) algorithms are skipped above it
+    long long min_key, max_key; //key range the algorithm can handle
+};
+
+const size_t QUADRATIC_MAX_SIZE = 1 << 14;
+
+vector<SortAlgorithm> sort_algorithms() {
+    const size_t ANY = SIZE_MAX;
+    return {
+            {"bubble_sort",         bubble_sort,         QUADRATIC_MAX_SIZE, INT_MIN, INT_MAX},
+            {"quick_sort",          quick_sort,          QUADRATIC_MAX_SIZE, INT_MIN, INT_MAX},
+            {"intro_sort",          intro_sort,          ANY,                INT_MIN, INT_MAX},
+            {"parallel_quick_sort", parallel_quick_sort, ANY,                INT_MIN, INT_MAX},
+            {"insert_sort",         insert_sort,         QUADRATIC_MAX_SIZE, INT_MIN, INT_MAX},
+            {"shell_sort",          shell_sort,          ANY,                INT_MIN, INT_MAX},
+            {"selection_sort",      selection_sort,      QUADRATIC_MAX_SIZE, INT_MIN, INT_MAX},
+            {"heap_sort",           heap_sort,           ANY,                INT_MIN, INT_MAX},
+            {"heap_sort_2",         heap_sort_dary<2>,   ANY,                INT_MIN, INT_MAX},
+            {"heap_sort_8",         heap_sort_dary<8>,   ANY,                INT_MIN, INT_MAX},
+            {"merge_sort_nrc",      merge_sort_nrc,      ANY,                INT_MIN, INT_MAX},
+            {"parallel_merge_sort", parallel_merge_sort, ANY,                INT_MIN, INT_MAX},
+            {"tim_sort",            tim_sort,            ANY,                INT_MIN, INT_MAX},
+            {"merge_sort_rc",       merge_sort_rc,       ANY,                INT_MIN, INT_MAX},
+            {"counting_sort",       counting_sort,       ANY,                INT_MIN, INT_MAX},
+            {"radix_sort_lsd",      radix_sort_lsd,      ANY,                INT_MIN, INT_MAX},
+            {"bucket_sort",         bucket_sort,         ANY,                INT_MIN, INT_MAX},
+    };
+}
+
+const vector<string> SORT_DISTRIBUTIONS = {
+        "uniform", "sorted", "reversed", "few_unique", "organ_pipe", "zipf", "sawtooth"
+};
+
+/**
+ * generate input of the given distribution
+ * @param dist: name of the distribution
+ * @param n: number of elements
+ * @param seed: seed of the random generator
+ * return: the input, empty if the distribution is unknown
+ */
+vector<int> generate_input(const string &dist, size_t n, unsigned seed) {
+    mt19937 gen(seed);
+    vector<int> arr(n);
+    if (dist == "uniform") {
+        uniform_int_distribution<int> uni(0, INT_MAX);
+        for (auto &item: arr)
+            item = uni(gen);
+    } else if (dist == "sorted" || dist == "reversed") {
+        for (size_t i = 0; i != n; ++i)
+            arr[i] = static_cast<int>(dist == "sorted" ? i : n - i);
+    } else if (dist == "few_unique") {
+        uniform_int_distribution<int> uni(0, 15);
+        for (auto &item: arr)
+            item = uni(gen) * 5;
+    } else if (dist == "organ_pipe") {
+        for (size_t i = 0; i != n; ++i)
+            arr[i] = static_cast<int>(i < n / 2 ? i : n - i);
+    } else if (dist == "zipf") {
+        //ranks 1..m with probability ~ 1/rank, sampled by binary search on the cdf
+        size_t m = min<size_t>(max<size_t>(n, 1), 1 << 20);
+        vector<double> cdf(m);
+        double sum = 0;
+        for (size_t r = 0; r != m; ++r)
+            cdf[r] = sum += 1.0 / (r + 1);
+        uniform_real_distribution<double> uni(0, sum);
+        for (auto &item: arr)
+            item = static_cast<int>(lower_bound(cdf.begin(), cdf.end(), uni(gen)) - cdf.begin());
+    } else if (dist == "sawtooth") {
+        size_t period = max<size_t>(n / 32, 1);
+        for (size_t i = 0; i != n; ++i)
+            arr[i] = static_cast<int>(i % period);
+    } else
+        arr.clear();
+    return arr;
+}
+
+struct BenchOptions {
+    vector<size_t> sizes{1 << 10, 1 << 14, 1 << 17, 1 << 20};
+    vector<string> dists = SORT_DISTRIBUTIONS;
+    vector<string> algos;   //empty means all
+    int warmup = 1;
+    int repeat = 5;
+    string format = "csv";  //csv or json
+    string output;          //empty means stdout
+    bool perf = false;      //report the counters of one more run, see common/perf_counter.h
+};
+
+struct BenchResult {
+    string algorithm, distribution;
+    size_t size;
+    int repeat;
+    double median_ms, min_ms, elements_per_sec;
+    bool correct;
+};
+
+/**
+ * parse a size like 1000, 64K, 16M or 1G
+ */
+size_t parse_size(const string &str) {
+    size_t pos = 0;
+    size_t value = stoull(str, &pos);
+    if (pos < str.size())
+        switch (toupper(str[pos])) {
+            case 'K': value <<= 10; break;
+            case 'M': value <<= 20; break;
+            case 'G': value <<= 30; break;
+            default: throw invalid_argument("bad size: " + str);
+        }
+    return value;
+}
+
+vector<string> split(const string &str, char sep) {
+    vector<string> items;
+    istringstream in(str);
+    string item;
+    while (getline(in, item, sep))
+        if (!item.empty())
+            items.push_back(item);
+    return items;
+}
+
+/**
+ * parse command line options of the benchmark
+ *  --sizes 1K,1M,1G --dists uniform,zipf --algos intro_sort,tim_sort
+ *  --warmup 1 --repeat 5 --format csv|json --output file --perf 0|1
+ * return: false if any option is invalid
+ */
+bool parse_bench_options(int argc, char *argv[], BenchOptions &opts) {
+    try {
+        for (int i = 1; i < argc; i += 2) {
+            string key = argv[i];
+            if (i + 1 >= argc) return false;
+            string value = argv[i + 1];
+            if (key == "--sizes") {
+                opts.sizes.clear();
+                for (const auto &item: split(value, ','))
+                    opts.sizes.push_back(parse_size(item));
+            } else if (key == "--dists")
+                opts.dists = split(value, ',');
+            else if (key == "--algos")
+                opts.algos = split(value, ',');
+            else if (key == "--warmup")
+                opts.warmup = stoi(value);
+            else if (key == "--repeat")
+                opts.repeat = max(stoi(value), 1);
+            else if (key == "--format")
+                opts.format = value;
+            else if (key == "--output")
+                opts.output = value;
+            else if (key == "--perf")
+                opts.perf = stoi(value) != 0;
+            else
+                return false;
+        }
+    } catch (const exception &) {
+        return false;
+    }
+    return opts.format == "csv" || opts.format == "json";
+}
+
+void print_results(const vector<BenchResult> &results, const string &format, ostream &out) {
+    if (format == "csv") {
+        out << "algorithm,distribution,size,repeat,median_ms,min_ms,elements_per_sec,correct" << endl;
+        for (const auto &r: results)
+            out << r.algorithm << "," << r.distribution << "," << r.size << "," << r.repeat << ","
+                << r.median_ms << "," << r.min_ms << "," << r.elements_per_sec << ","
+                << (r.correct ? "true" : "false") << endl;
+        return;
+    }
+
+    out << "[" << endl;
+    for (size_t i = 0; i != results.size(); ++i) {
+        const auto &r = results[i];
+        out << "  {\"algorithm\": \"" << r.algorithm << "\", \"distribution\": \"" << r.distribution
+            << "\", \"size\": " << r.size << ", \"repeat\": " << r.repeat << ", \"median_ms\": " << r.median_ms
+            << ", \"min_ms\": " << r.min_ms << ", \"elements_per_sec\": " << r.elements_per_sec
+            << ", \"correct\": " << (r.correct ? "true" : "false") << "}" << (i + 1 == results.size() ? "" : ",")
+            << endl;
+    }
+    out << "]" << endl;
+}
+
+/**
+ * @param opts: sizes, distributions, algorithms and output of the benchmark
+ * return: false if any algorithm gives a wrong result
+ */
+bool benchmark_sort(const BenchOptions &opts) {
+    using clock = chrono::steady_clock;
+    vector<SortAlgorithm> algorithms;
+    for (const auto &algo: sort_algorithms())
+        if (opts.algos.empty() || find(opts.algos.begin(), opts.algos.end(), algo.name) != opts.algos.end())
+            algorithms.push_back(algo);
+
+    vector<BenchResult> results;
+    bool all_correct = true;
+    for (auto n: opts.sizes)
+        for (const auto &dist: opts.dists) {
+            vector<int> input = generate_input(dist, n, 2018);
+            if (input.size() != n) {
+                cerr << "unknown distribution: " << dist << endl;
+                continue;
+            }
+            vector<int> expected = input;
+            sort(expected.begin(), expected.end());
+            long long min_key = n ? expected.front() : 0, max_key = n ? expected.back() : 0;
+
+            vector<int> arr;
+            for (const auto &algo: algorithms) {
+                if (n > algo.max_size || min_key < algo.min_key || max_key > algo.max_key)
+                    continue;
+
+                for (int k = 0; k < opts.warmup; ++k) {
+                    arr = input;
+                    algo.sort(arr);
+                }
+
+                vector<double> times;
+                bool correct = true;
+                for (int k = 0; k < opts.repeat; ++k) {
+                    arr = input;
+                    auto start = clock::now();
+                    algo.sort(arr);
+                    times.push_back(chrono::duration<double, milli>(clock::now() - start).count());
+                    correct = correct && arr == expected;
+                }
+                sort(times.begin(), times.end());
+                double median = times.size() % 2 ? times[times.size() / 2]
+                                                 : (times[times.size() / 2 - 1] + times[times.size() / 2]) / 2;
+                double eps = median > 0 ? n / (median / 1000) : 0;
+                results.push_back({algo.name, dist, n, opts.repeat, median, times.front(), eps, correct});
+
+                if (opts.perf) {
+                    arr = input;
+                    perf::measure(algo.name + " " + dist + " " + to_string(n), algo.sort, arr).print(cerr);
+                }
+                all_correct = all_correct && correct;
+            }
+        }
+
+    if (opts.output.empty())
+        print_results(results, opts.format, cout);
+    else {
+        ofstream out(opts.output);
+        print_results(results, opts.format, out);
+    }
+    return all_correct;
+}
+
+int main(int argc, char *argv[]) {
 //    test_sort(bubble_sort);
 //    test_sort(quick_sort);
+//    test_sort(intro_sort);
+//    test_sort(parallel_quick_sort);
 //    test_sort(insert_sort);
 //    test_sort(shell_sort);
 //    test_sort(selection_sort);
 //    test_sort(heap_sort);
 //    test_sort(merge_sort_nrc);
+//    test_sort(parallel_merge_sort);
+//    test_sort(tim_sort);
 //    test_sort(merge_sort_rc);
 //    test_sort(counting_sort);
-//    test_sort(radix_sort_1);
-//    test_sort(radix_sort_2);
+//    test_sort(radix_sort_lsd);
 //    test_sort(bucket_sort);
+//    test_generic_sort();
+//    test_multiway_merge();
+//    test_external_sort();
 
-    return 0;
+    BenchOptions opts;
+    if (!parse_bench_options(argc, argv, opts)) {
+        cerr << "usage: " << argv[0] << " [--sizes 1K,1M,1G] [--dists ";
+        for (size_t i = 0; i != SORT_DISTRIBUTIONS.size(); ++i)
+            cerr << (i ? "," : "") << SORT_DISTRIBUTIONS[i];
+        cerr << "] [--algos intro_sort,tim_sort] [--warmup 1] [--repeat 5] [--format csv|json] [--output file]"
+             << " [--perf 0|1]" << endl;
+        return 1;
+    }
+    return benchmark_sort(opts) ? 0 : 2;
 }
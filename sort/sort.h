@@ -0,0 +1,1149 @@
+#ifndef ALGORITHMS_SORT_H
+#define ALGORITHMS_SORT_H
+
+/*
+ *  Copyright(c) 2018 Gang Zhang
+ *  All rights reserved.
+ *  Author: Gang Zhang
+ *  Creation date: 2026.10.17
+ *  Last modified: 2026.10.17
+ *
+ *  Function:
+ *      generic sorting algorithms over random-access iterators
+ *      every algorithm takes a comparator, by_key(key) turns a key extractor into a comparator
+ *      sort_by_key dispatches integral and floating keys to radix sort at compile time
+ *      nth_element, partial_sort and top_k select elements without sorting the whole range
+ *      multiway_merge merges many sorted runs by a loser tree, from spans or pull-based streams
+ *      argsort and sort_pairs order indices or payloads by keys without sorting pairs
+ *      string_sort sorts and dedups strings by multikey quick sort on cached 8-byte chunks
+ */
+
+#include <cmath>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <future>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+namespace algo {
+
+namespace detail {
+template<typename It>
+using value_t = typename std::iterator_traits<It>::value_type;
+
+template<typename It>
+using diff_t = typename std::iterator_traits<It>::difference_type;
+}
+
+/**
+ * comparator which compares the keys extracted from the elements
+ */
+template<typename Key>
+struct key_less {
+    Key key;
+
+    template<typename A, typename B>
+    bool operator()(const A &a, const B &b) const { return key(a) < key(b); }
+};
+
+template<typename Key>
+key_less<Key> by_key(Key key) {
+    return key_less<Key>{key};
+}
+
+/**
+ * key extractor returning the element itself
+ */
+struct identity {
+    template<typename T>
+    const T &operator()(const T &x) const { return x; }
+};
+
+/**
+ * bubble sort(stable):
+ *  record the last exchanged position, elements above it must be ordered
+ *  time complexity: O(n^2)
+ *  space complexity: O(1)
+ * @param first: iterator of the first element
+ * @param last: iterator after the last element
+ * @param comp: comparator, returns true if a should be ordered before b
+ * return: none
+ */
+template<typename It, typename Comp = std::less<>>
+void bubble_sort(It first, It last, Comp comp = Comp()) {
+    auto sz = last - first;
+    for (decltype(sz) i = 0; i < sz - 1;) {
+        auto next = sz - 1;
+        for (auto j = sz - 1; j != i; --j)
+            if (comp(first[j], first[j - 1])) {
+                std::iter_swap(first + (j - 1), first + j);
+                next = j;
+            }
+        i = next;
+    }
+}
+
+/**
+ * insert sort(stable):
+ *  binary search for the position to insert
+ *  time complexity: O(n^2)
+ *  space complexity: O(1)
+ */
+template<typename It, typename Comp = std::less<>>
+void insert_sort(It first, It last, Comp comp = Comp()) {
+    if (last - first < 2) return;
+    for (It cur = first + 1; cur != last; ++cur)
+        if (comp(*cur, *(cur - 1))) {
+            auto tmp = std::move(*cur);
+            It pos = std::upper_bound(first, cur, tmp, comp); //after the equal elements to keep stable
+            std::move_backward(pos, cur, cur + 1);
+            *pos = std::move(tmp);
+        }
+}
+
+/**
+ * shell sort(not stable):
+ *  time complexity: O(nlogn) - O(n^2)
+ *  space complexity: O(1)
+ */
+template<typename It, typename Comp = std::less<>>
+void shell_sort(It first, It last, Comp comp = Comp()) {
+    auto sz = last - first;
+    for (auto d = sz / 2; d >= 1; d /= 2)
+        for (auto i = d; i < sz; ++i) {
+            auto tmp = std::move(first[i]);
+            auto j = i;
+            for (; j >= d && comp(tmp, first[j - d]); j -= d)
+                first[j] = std::move(first[j - d]);
+            first[j] = std::move(tmp);
+        }
+}
+
+/**
+ * selection sort(not stable):
+ *  time complexity: O(n^2)
+ *  space complexity: O(1)
+ */
+template<typename It, typename Comp = std::less<>>
+void selection_sort(It first, It last, Comp comp = Comp()) {
+    for (; first != last; ++first) {
+        It min_pos = first;
+        for (It it = first + 1; it != last; ++it)
+            if (comp(*it, *min_pos))
+                min_pos = it;
+        if (min_pos != first)
+            std::iter_swap(first, min_pos);
+    }
+}
+
+namespace detail {
+/**
+ * push down the element at pos in the 0-based max-heap [first, first + sz)
+ */
+template<typename It, typename Comp>
+void push_down(It first, diff_t<It> pos, diff_t<It> sz, Comp comp) {
+    auto tmp = std::move(first[pos]);
+    auto next = 2 * pos + 1;
+    while (next < sz) {
+        if (next + 1 < sz && comp(first[next], first[next + 1]))
+            next += 1;
+        if (!comp(tmp, first[next])) break;
+        first[pos] = std::move(first[next]);
+        pos = next;
+        next = 2 * next + 1;
+    }
+    first[pos] = std::move(tmp);
+}
+}
+
+/**
+ * heap sort(not stable):
+ *  build max-heap in place, swap the head and tail elements until all elements be ordered
+ *  time complexity: O(nlogn)
+ *  space complexity: O(1)
+ */
+template<typename It, typename Comp = std::less<>>
+void heap_sort(It first, It last, Comp comp = Comp()) {
+    auto sz = last - first;
+    for (auto i = sz / 2 - 1; i >= 0; --i)
+        detail::push_down(first, i, sz, comp);
+    for (auto i = sz - 1; i >= 1; --i) {
+        std::iter_swap(first, first + i);
+        detail::push_down(first, decltype(sz)(0), i, comp);
+    }
+}
+
+namespace detail {
+/**
+ * move the median of first + 1, middle and last - 1 to first as the pivot
+ *  the maximum of three stays at last - 1 and stops the left scan of the partition
+ */
+template<typename It, typename Comp>
+void median_to_first(It first, It last, Comp comp) {
+    It mid = first + (last - first) / 2;
+    if (comp(*mid, *(first + 1))) std::iter_swap(first + 1, mid);
+    if (comp(*(last - 1), *mid)) std::iter_swap(mid, last - 1);
+    if (comp(*mid, *(first + 1))) std::iter_swap(first + 1, mid);
+    std::iter_swap(first, mid);
+}
+
+template<typename It, typename Comp>
+void quick_sort_child(It first, It last, int depth, Comp comp) {
+    while (last - first > 16) {
+        if (depth-- == 0) { //too many bad partitions
+            algo::heap_sort(first, last, comp);
+            return;
+        }
+
+        //median of three as pivot
+        detail::median_to_first(first, last, comp);
+
+        //hoare partition, the pivot stays at first until the end
+        It left = first, right = last;
+        while (true) {
+            do ++left; while (comp(*left, *first));
+            do --right; while (comp(*first, *right));
+            if (left >= right) break;
+            std::iter_swap(left, right);
+        }
+        std::iter_swap(first, right);
+
+        //recurse into the smaller part, loop on the larger part
+        if (right - first < last - right) {
+            detail::quick_sort_child(first, right, depth, comp);
+            first = right + 1;
+        } else {
+            detail::quick_sort_child(right + 1, last, depth, comp);
+            last = right;
+        }
+    }
+    algo::insert_sort(first, last, comp);
+}
+}
+
+/**
+ * quick sort(not stable):
+ *  median of three as pivot, hoare partition handles duplicates evenly
+ *  switch to heap sort after 2logn levels, use insert sort for small parts
+ *  time complexity: O(nlogn)
+ *  space complexity: O(logn)
+ */
+template<typename It, typename Comp = std::less<>>
+void quick_sort(It first, It last, Comp comp = Comp()) {
+    int depth = 0;
+    for (auto n = last - first; n > 1; n >>= 1)
+        depth += 2;
+    detail::quick_sort_child(first, last, depth, comp);
+}
+
+namespace detail {
+const std::ptrdiff_t FLOYD_RIVEST_THRESHOLD = 600; //ranges larger than it sample the pivot
+
+/**
+ * max-heap of [first, middle) keeps the smallest middle - first elements of [first, last)
+ *  after the heap is built, most elements only cost one compare with the top
+ */
+template<typename It, typename Comp>
+void heap_select(It first, It middle, It last, Comp comp) {
+    auto k = middle - first;
+    for (auto i = k / 2 - 1; i >= 0; --i)
+        detail::push_down(first, i, k, comp);
+    for (It it = middle; it != last; ++it)
+        if (comp(*it, *first)) {
+            std::iter_swap(first, it);
+            detail::push_down(first, decltype(k)(0), k, comp);
+        }
+}
+
+/**
+ * hoare partition around the pivot at first, returns the final position of the pivot
+ *  scans stop at elements equal to the pivot, so duplicates are split evenly
+ */
+template<typename It, typename Comp>
+It partition_pivot(It first, It last, Comp comp) {
+    It left = first, right = last;
+    while (true) {
+        do ++left; while (left != last && comp(*left, *first));
+        do --right; while (comp(*first, *right));
+        if (left >= right) break;
+        std::iter_swap(left, right);
+    }
+    std::iter_swap(first, right);
+    return right;
+}
+
+template<typename It, typename Comp>
+void select_child(It first, It nth, It last, int depth, Comp comp) {
+    while (last - first > 16) {
+        if (depth-- == 0) { //too many bad partitions
+            detail::heap_select(first, nth + 1, last, comp);
+            std::iter_swap(first, nth);
+            return;
+        }
+
+        auto n = last - first;
+        if (n > FLOYD_RIVEST_THRESHOLD) {
+            //floyd-rivest: select in a sample around nth, whose nth element is very close to the answer
+            double z = std::log(double(n)), s = 0.5 * std::exp(2 * z / 3), k = double(nth - first);
+            double sd = 0.5 * std::sqrt(z * s * (n - s) / n) * (k < n / 2 ? -1 : 1);
+            auto low = std::max(diff_t<It>(0), diff_t<It>(k - k * s / n + sd));
+            auto high = std::min(n, diff_t<It>(k + (n - k) * s / n + sd) + 1);
+            low = std::min(low, nth - first);
+            high = std::max(high, nth - first + 1);
+            detail::select_child(first + low, nth, first + high, depth, comp);
+            std::iter_swap(first, nth);
+        } else
+            detail::median_to_first(first, last, comp);
+
+        It pos = detail::partition_pivot(first, last, comp);
+        if (pos == nth) return;
+        if (pos < nth)
+            first = pos + 1;
+        else
+            last = pos;
+    }
+    algo::insert_sort(first, last, comp);
+}
+}
+
+/**
+ * nth element(introselect):
+ *  place the element at nth which would be there if the range were sorted,
+ *  elements before it are not greater, elements after it are not less
+ *  pivots of large ranges come from floyd-rivest sampling, small ranges use median of three
+ *  switch to heap selection after 2logn levels
+ *  time complexity: average-O(n), worst-O(nlogn)
+ *  space complexity: O(logn)
+ * @param first: iterator of the first element
+ * @param nth: iterator of the position to select
+ * @param last: iterator after the last element
+ * @param comp: comparator, returns true if a should be ordered before b
+ * return: none
+ */
+template<typename It, typename Comp = std::less<>>
+void nth_element(It first, It nth, It last, Comp comp = Comp()) {
+    if (nth == last) return;
+    int depth = 0;
+    for (auto n = last - first; n > 1; n >>= 1)
+        depth += 2;
+    detail::select_child(first, nth, last, depth, comp);
+}
+
+/**
+ * partial sort(not stable):
+ *  sort the smallest middle - first elements into [first, middle), the rest are left unordered
+ *  small k: keep the k smallest elements in a max-heap, then sort the heap
+ *  large k: select the kth element, then sort the elements before it
+ *  time complexity: O(nlogk) for small k, average-O(n + klogk) for large k
+ *  space complexity: O(logn)
+ */
+template<typename It, typename Comp = std::less<>>
+void partial_sort(It first, It middle, It last, Comp comp = Comp()) {
+    auto k = middle - first;
+    if (k <= 0) return;
+    if (k < (last - first) / 16) {
+        detail::heap_select(first, middle, last, comp);
+        for (auto i = k - 1; i >= 1; --i) {
+            std::iter_swap(first, first + i);
+            detail::push_down(first, decltype(k)(0), i, comp);
+        }
+    } else {
+        algo::nth_element(first, middle - 1, last, comp);
+        algo::quick_sort(first, middle - 1, comp);
+    }
+}
+
+/**
+ * top k(not stable):
+ *  smallest k elements of a stream in order, one pass over input iterators
+ *  a bounded max-heap holds the candidates, an element replaces the top only if it is smaller,
+ *  pass std::greater<>() to get the largest k elements
+ *  time complexity: O(nlogk)
+ *  space complexity: O(k)
+ * @param first: input iterator of the first element
+ * @param last: input iterator after the last element
+ * @param k: number of elements to keep
+ * @param comp: comparator, returns true if a should be ordered before b
+ * return: the smallest k elements in order, all elements if there are fewer
+ */
+template<typename InIt, typename Comp = std::less<>>
+std::vector<detail::value_t<InIt>> top_k(InIt first, InIt last, size_t k, Comp comp = Comp()) {
+    std::vector<detail::value_t<InIt>> heap;
+    if (k == 0) return heap;
+    for (; first != last && heap.size() < k; ++first)
+        heap.push_back(*first);
+
+    auto sz = static_cast<std::ptrdiff_t>(heap.size());
+    for (auto i = sz / 2 - 1; i >= 0; --i)
+        detail::push_down(heap.begin(), i, sz, comp);
+    for (; first != last; ++first)
+        if (comp(*first, heap.front())) {
+            heap.front() = *first;
+            detail::push_down(heap.begin(), std::ptrdiff_t(0), sz, comp);
+        }
+
+    for (auto i = sz - 1; i >= 1; --i) {
+        std::swap(heap[0], heap[i]);
+        detail::push_down(heap.begin(), std::ptrdiff_t(0), i, comp);
+    }
+    return heap;
+}
+
+namespace detail {
+/**
+ * merge two ordered sequences [first, mid) and [mid, last) of src into dst
+ *  elements of the first sequence are taken first when equal, to keep stable
+ */
+template<typename InIt, typename OutIt, typename Comp>
+void merge(InIt first, InIt mid, InIt last, OutIt dst, Comp comp) {
+    InIt i = first, j = mid;
+    while (i != mid && j != last)
+        *dst++ = comp(*j, *i) ? std::move(*j++) : std::move(*i++);
+    dst = std::move(i, mid, dst);
+    std::move(j, last, dst);
+}
+
+/**
+ * merge every two h-length sequences of src into dst
+ */
+template<typename InIt, typename OutIt, typename Comp>
+void merge_pass(diff_t<InIt> h, InIt src, diff_t<InIt> sz, OutIt dst, Comp comp) {
+    diff_t<InIt> i = 0;
+    for (; i + 2 * h <= sz; i += 2 * h)
+        detail::merge(src + i, src + i + h, src + i + 2 * h, dst + i, comp);
+    if (i + h < sz)
+        detail::merge(src + i, src + i + h, src + sz, dst + i, comp);
+    else
+        std::move(src + i, src + sz, dst + i);
+}
+}
+
+/**
+ * merge sort(stable):
+ *  from bottom to the up, not recursively
+ *  time complexity: O(nlogn)
+ *  space complexity: O(n)
+ */
+template<typename It, typename Comp = std::less<>>
+void merge_sort_nrc(It first, It last, Comp comp = Comp()) {
+    auto sz = last - first;
+    std::vector<detail::value_t<It>> dev(sz);
+    for (decltype(sz) h = 1; h < sz; h *= 2) {
+        detail::merge_pass(h, first, sz, dev.begin(), comp); //merge elements from range to dev
+        h *= 2;
+        detail::merge_pass(h, dev.begin(), sz, first, comp); //merge elements from dev to range
+    }
+}
+
+namespace detail {
+template<typename It, typename BufIt, typename Comp>
+void merge_sort_child(It first, It last, BufIt buf, Comp comp) {
+    if (last - first < 2) return;
+    It mid = first + (last - first) / 2;
+    detail::merge_sort_child(first, mid, buf, comp);
+    detail::merge_sort_child(mid, last, buf, comp);
+    detail::merge(first, mid, last, buf, comp);
+    std::move(buf, buf + (last - first), first);
+}
+}
+
+/**
+ * merge sort(stable):
+ *  from top to the bottom, recursively
+ *  time complexity: O(nlogn)
+ *  space complexity: O(n)
+ */
+template<typename It, typename Comp = std::less<>>
+void merge_sort_rc(It first, It last, Comp comp = Comp()) {
+    std::vector<detail::value_t<It>> dev(last - first);
+    detail::merge_sort_child(first, last, dev.begin(), comp);
+}
+
+/**
+ * loser tree for k-way merge:
+ *  leaves are the current keys of the k sources, every inner node keeps the loser of
+ *  the match under it and the overall winner is kept at node 0
+ *  replacing the winner's key replays only the matches on its path: O(logk) comparisons
+ *  equal keys are won by the source with the smaller index, so the merge is stable
+ *  exhausted sources lose every match
+ */
+template<typename T, typename Comp = std::less<>>
+class LoserTree {
+public:
+    explicit LoserTree(size_t k, Comp comp = Comp())
+            : k(k), tree(k, 0), keys(k), done(k, true), comp(comp) {}
+
+    /**
+     * set the first key of source i, call build() after all sources are set
+     */
+    void set(size_t i, const T &key) {
+        keys[i] = key;
+        done[i] = false;
+    }
+
+    void build() {
+        if (k == 0) return;
+        std::vector<size_t> win(2 * k);
+        for (size_t i = 0; i != k; ++i)
+            win[k + i] = i;
+        for (size_t n = k - 1; n >= 1; --n) {
+            size_t l = win[2 * n], r = win[2 * n + 1];
+            win[n] = less(l, r) ? l : r;
+            tree[n] = less(l, r) ? r : l;
+        }
+        tree[0] = k > 1 ? win[1] : 0;
+    }
+
+    bool empty() const { return k == 0 || done[tree[0]]; }
+
+    size_t top() const { return tree[0]; }
+
+    const T &top_key() const { return keys[tree[0]]; }
+
+    /**
+     * the winner source moves to its next key
+     */
+    void replace(const T &key) {
+        keys[tree[0]] = key;
+        replay();
+    }
+
+    /**
+     * the winner source is exhausted
+     */
+    void pop() {
+        done[tree[0]] = true;
+        replay();
+    }
+
+private:
+    bool less(size_t a, size_t b) const {
+        if (done[a] || done[b]) return !done[a] && done[b];
+        if (comp(keys[a], keys[b])) return true;
+        if (comp(keys[b], keys[a])) return false;
+        return a < b;
+    }
+
+    void replay() {
+        size_t winner = tree[0];
+        for (size_t n = (winner + k) / 2; n >= 1; n /= 2)
+            if (less(tree[n], winner))
+                std::swap(tree[n], winner);
+        tree[0] = winner;
+    }
+
+    size_t k;
+    std::vector<size_t> tree;
+    std::vector<T> keys;
+    std::vector<char> done;
+    Comp comp;
+};
+namespace detail {
+/**
+ * compare the elements the iterators point to
+ */
+template<typename Comp>
+struct deref_less {
+    Comp comp;
+
+    template<typename It>
+    bool operator()(const It &a, const It &b) const { return comp(*a, *b); }
+};
+
+/**
+ * split sorted runs at the output rank r of their stable merge:
+ *  element x of run i goes before element y of run j iff x < y, or they are equal and
+ *  (i, position) < (j, position), so split[i] elements of run i are among the first r
+ *  every step takes the middle of the widest window as candidate, counts the elements
+ *  ordered before it by binary search, and narrows the windows of all runs by the count
+ *  time complexity: O(k^2 * log^2(n)) for the worst case, usually O(k * log^2(n))
+ */
+template<typename It, typename Comp>
+std::vector<diff_t<It>> co_rank(const std::vector<std::pair<It, It>> &runs, diff_t<It> r, Comp comp) {
+    size_t k = runs.size();
+    std::vector<diff_t<It>> low(k, 0), high(k), pos(k);
+    for (size_t i = 0; i != k; ++i)
+        high[i] = runs[i].second - runs[i].first;
+
+    while (k != 0) {
+        size_t j = 0;
+        for (size_t i = 1; i != k; ++i)
+            if (high[i] - low[i] > high[j] - low[j])
+                j = i;
+        if (high[j] == low[j])
+            return low;
+
+        diff_t<It> mid = low[j] + (high[j] - low[j]) / 2, total = 0;
+        const auto &pivot = runs[j].first[mid];
+        for (size_t i = 0; i != k; ++i) {
+            if (i < j)
+                pos[i] = std::upper_bound(runs[i].first, runs[i].second, pivot, comp) - runs[i].first;
+            else if (i > j)
+                pos[i] = std::lower_bound(runs[i].first, runs[i].second, pivot, comp) - runs[i].first;
+            else
+                pos[i] = mid;
+            total += pos[i];
+        }
+
+        if (total == r)
+            return pos;
+        for (size_t i = 0; i != k; ++i)
+            if (total < r) //the pivot and everything before it are among the first r
+                low[i] = std::max(low[i], pos[i] + (i == j));
+            else
+                high[i] = std::min(high[i], pos[i]);
+    }
+    return low;
+}
+}
+
+/**
+ * k-way merge(stable):
+ *  merge the sorted runs [runs[i].first, runs[i].second) into dst by a loser tree of
+ *  iterators, the runs are read and dst is written sequentially
+ *  equal elements are taken in the order of runs
+ *  time complexity: O(nlogk)
+ *  space complexity: O(k)
+ * @param runs: begin and end iterators of every sorted run
+ * @param dst: output iterator of the merged sequence
+ * @param comp: comparator, returns true if a should be ordered before b
+ * return: output iterator after the last merged element
+ */
+template<typename It, typename OutIt, typename Comp = std::less<>>
+OutIt multiway_merge(const std::vector<std::pair<It, It>> &runs, OutIt dst, Comp comp = Comp()) {
+    std::vector<std::pair<It, It>> rest;
+    for (const auto &run: runs)
+        if (run.first != run.second)
+            rest.push_back(run);
+    if (rest.size() == 1)
+        return std::copy(rest[0].first, rest[0].second, dst);
+
+    LoserTree<It, detail::deref_less<Comp>> tree(rest.size(), detail::deref_less<Comp>{comp});
+    for (size_t i = 0; i != rest.size(); ++i)
+        tree.set(i, rest[i].first);
+    tree.build();
+    while (!tree.empty()) {
+        It it = tree.top_key();
+        *dst++ = *it;
+        if (++it != rest[tree.top()].second)
+            tree.replace(it);
+        else
+            tree.pop();
+    }
+    return dst;
+}
+
+/**
+ * k-way merge(stable) of pull-based streams:
+ *  every source is a callable bool(T &), which saves its next element and returns false
+ *  when it is exhausted, so only k elements are held in memory
+ *  time complexity: O(nlogk)
+ *  space complexity: O(k)
+ * @param sources: sorted streams, T must be given explicitly, e.g. multiway_merge_stream<int>
+ * @param dst: output iterator of the merged sequence
+ * @param comp: comparator, returns true if a should be ordered before b
+ * return: output iterator after the last merged element
+ */
+template<typename T, typename Source, typename OutIt, typename Comp = std::less<>>
+OutIt multiway_merge_stream(std::vector<Source> &sources, OutIt dst, Comp comp = Comp()) {
+    LoserTree<T, Comp> tree(sources.size(), comp);
+    T value;
+    for (size_t i = 0; i != sources.size(); ++i)
+        if (sources[i](value))
+            tree.set(i, value);
+    tree.build();
+    while (!tree.empty()) {
+        *dst++ = tree.top_key();
+        if (sources[tree.top()](value))
+            tree.replace(value);
+        else
+            tree.pop();
+    }
+    return dst;
+}
+
+/**
+ * parallel k-way merge(stable):
+ *  cut the output into parts of equal size, find the co-ranks of every cut in all runs,
+ *  then every part merges its own pieces of the runs into its own range of dst
+ *  the parts are merged by asynchronous tasks, the last one by the caller
+ *  time complexity: O(nlogk/p + p*k*log^2(n))
+ *  space complexity: O(p*k)
+ * @param runs: begin and end iterators of every sorted run
+ * @param dst: random access iterator of the merged sequence
+ * @param parts: number of parts merged concurrently
+ * @param comp: comparator, returns true if a should be ordered before b
+ * return: iterator after the last merged element
+ */
+template<typename It, typename OutIt, typename Comp = std::less<>>
+OutIt parallel_multiway_merge(const std::vector<std::pair<It, It>> &runs, OutIt dst, size_t parts,
+                              Comp comp = Comp()) {
+    detail::diff_t<It> sz = 0;
+    for (const auto &run: runs)
+        sz += run.second - run.first;
+    parts = std::max<size_t>(1, std::min<size_t>(parts, static_cast<size_t>(sz)));
+
+    std::vector<std::vector<detail::diff_t<It>>> cut(parts + 1);
+    for (size_t p = 0; p <= parts; ++p)
+        cut[p] = detail::co_rank(runs, static_cast<detail::diff_t<It>>(sz * p / parts), comp);
+
+    auto merge_part = [&](size_t p) {
+        std::vector<std::pair<It, It>> pieces;
+        for (size_t i = 0; i != runs.size(); ++i)
+            pieces.emplace_back(runs[i].first + cut[p][i], runs[i].first + cut[p + 1][i]);
+        algo::multiway_merge(pieces, dst + sz * p / parts, comp);
+    };
+    std::vector<std::future<void>> tasks;
+    for (size_t p = 0; p + 1 < parts; ++p)
+        tasks.push_back(std::async(std::launch::async, merge_part, p));
+    merge_part(parts - 1);
+    for (auto &task: tasks)
+        task.get();
+    return dst + sz;
+}
+
+namespace detail {
+/**
+ * keys radix sort can handle: integral types except bool, float and double
+ */
+template<typename K>
+struct is_radix_key : std::integral_constant<bool,
+        (std::is_integral<K>::value && !std::is_same<K, bool>::value)
+        || std::is_same<K, float>::value || std::is_same<K, double>::value> {
+};
+
+/**
+ * map a key to an unsigned integer with the same order
+ *  signed integers: flip the sign bit
+ *  floating numbers: flip all bits of negative numbers, flip the sign bit of the others
+ */
+template<typename K>
+typename std::enable_if<std::is_integral<K>::value, typename std::make_unsigned<K>::type>::type
+radix_bits(K key) {
+    using U = typename std::make_unsigned<K>::type;
+    if (std::is_signed<K>::value)
+        return static_cast<U>(key) ^ static_cast<U>(U(1) << (sizeof(U) * 8 - 1));
+    return static_cast<U>(key);
+}
+
+inline uint32_t radix_bits(float key) {
+    uint32_t bits;
+    std::memcpy(&bits, &key, sizeof(bits));
+    return bits >> 31 ? ~bits : bits | 0x80000000u;
+}
+
+inline uint64_t radix_bits(double key) {
+    uint64_t bits;
+    std::memcpy(&bits, &key, sizeof(bits));
+    return bits >> 63 ? ~bits : bits | 0x8000000000000000ull;
+}
+}
+
+/**
+ * radix sort(stable):
+ *  least significant byte first on the key extracted from every element
+ *  histograms of all bytes are counted in a single pass, passes ping-pong between
+ *  the range and one scratch buffer, a pass is skipped when all keys share the byte
+ *  time complexity: O(w*(n+256)), w - bytes of the key
+ *  space complexity: O(n)
+ * @param first: iterator of the first element
+ * @param last: iterator after the last element
+ * @param key: key extractor, returns an integral or floating key
+ * return: none
+ */
+template<typename It, typename Key = identity>
+void radix_sort(It first, It last, Key key = Key()) {
+    using K = typename std::decay<decltype(key(*first))>::type;
+    static_assert(detail::is_radix_key<K>::value, "radix sort needs an integral or floating key");
+    using U = decltype(detail::radix_bits(K()));
+    const int PASSES = sizeof(U), BUCKETS = 256;
+
+    auto sz = last - first;
+    if (sz < 2) return;
+
+    std::vector<size_t> count(PASSES * BUCKETS, 0);
+    for (It it = first; it != last; ++it) {
+        U bits = detail::radix_bits(key(*it));
+        for (int pass = 0; pass != PASSES; ++pass)
+            count[pass * BUCKETS + (bits >> (pass * 8) & 0xFF)]++;
+    }
+
+    auto scatter = [&key](auto src, auto src_end, auto dst, int shift, size_t *cnt) {
+        for (; src != src_end; ++src)
+            dst[cnt[detail::radix_bits(key(*src)) >> shift & 0xFF]++] = std::move(*src);
+    };
+
+    std::vector<detail::value_t<It>> dev(sz);
+    bool in_dev = false; //whether the elements are in dev now
+    for (int pass = 0; pass != PASSES; ++pass) {
+        int shift = pass * 8;
+        size_t *cnt = &count[pass * BUCKETS];
+        U bits = detail::radix_bits(key(in_dev ? dev[0] : *first));
+        if (cnt[bits >> shift & 0xFF] == static_cast<size_t>(sz))
+            continue;
+
+        size_t sum = 0;
+        for (int r = 0; r != BUCKETS; ++r) {
+            size_t tmp = cnt[r];
+            cnt[r] = sum;
+            sum += tmp;
+        }
+
+        if (in_dev)
+            scatter(dev.begin(), dev.end(), first, shift, cnt);
+        else
+            scatter(first, last, dev.begin(), shift, cnt);
+        in_dev = !in_dev;
+    }
+
+    if (in_dev)
+        std::move(dev.begin(), dev.end(), first);
+}
+
+namespace detail {
+template<typename It, typename Key>
+void sort_by_key(It first, It last, Key key, std::true_type) {
+    algo::radix_sort(first, last, key);
+}
+
+template<typename It, typename Key>
+void sort_by_key(It first, It last, Key key, std::false_type) {
+    algo::quick_sort(first, last, by_key(key));
+}
+}
+
+/**
+ * sort elements by the key extracted from them
+ *  integral and floating keys go to the stable radix sort, other keys go to quick sort
+ * @param first: iterator of the first element
+ * @param last: iterator after the last element
+ * @param key: key extractor
+ * return: none
+ */
+template<typename It, typename Key = identity>
+void sort_by_key(It first, It last, Key key = Key()) {
+    using K = typename std::decay<decltype(key(*first))>::type;
+    detail::sort_by_key(first, last, key, detail::is_radix_key<K>());
+}
+
+namespace detail {
+/**
+ * key of an element with its index, sorted together so the key is read sequentially
+ */
+template<typename K>
+struct keyed_index {
+    K key;
+    uint32_t index;
+};
+
+template<typename It, typename Key>
+std::vector<uint32_t> argsort(It first, It last, Key key, std::true_type) {
+    using U = decltype(detail::radix_bits(key(*first)));
+    auto sz = last - first;
+    std::vector<keyed_index<U>> items(sz);
+    for (diff_t<It> i = 0; i != sz; ++i)
+        items[i] = {detail::radix_bits(key(first[i])), static_cast<uint32_t>(i)};
+    algo::radix_sort(items.begin(), items.end(), [](const keyed_index<U> &x) { return x.key; });
+
+    std::vector<uint32_t> perm(sz);
+    for (diff_t<It> i = 0; i != sz; ++i)
+        perm[i] = items[i].index;
+    return perm;
+}
+
+template<typename It, typename Key>
+std::vector<uint32_t> argsort(It first, It last, Key key, std::false_type) {
+    using K = typename std::decay<decltype(key(*first))>::type;
+    auto sz = last - first;
+    std::vector<keyed_index<K>> items(sz);
+    for (diff_t<It> i = 0; i != sz; ++i)
+        items[i] = {key(first[i]), static_cast<uint32_t>(i)};
+    algo::merge_sort_nrc(items.begin(), items.end(),
+                         [](const keyed_index<K> &a, const keyed_index<K> &b) { return a.key < b.key; });
+
+    std::vector<uint32_t> perm(sz);
+    for (diff_t<It> i = 0; i != sz; ++i)
+        perm[i] = items[i].index;
+    return perm;
+}
+
+/**
+ * radix sort(stable) of split key and value arrays, every pass scatters both arrays
+ */
+template<typename KeyIt, typename ValueIt>
+void radix_sort_pairs(KeyIt kfirst, KeyIt klast, ValueIt vfirst) {
+    using U = decltype(detail::radix_bits(*kfirst));
+    const int PASSES = sizeof(U), BUCKETS = 256;
+    auto sz = klast - kfirst;
+
+    std::vector<size_t> count(PASSES * BUCKETS, 0);
+    for (KeyIt it = kfirst; it != klast; ++it) {
+        U bits = detail::radix_bits(*it);
+        for (int pass = 0; pass != PASSES; ++pass)
+            count[pass * BUCKETS + (bits >> (pass * 8) & 0xFF)]++;
+    }
+
+    auto scatter = [sz](auto ksrc, auto vsrc, auto kdst, auto vdst, int shift, size_t *cnt) {
+        for (decltype(sz) i = 0; i != sz; ++i) {
+            size_t pos = cnt[detail::radix_bits(ksrc[i]) >> shift & 0xFF]++;
+            kdst[pos] = std::move(ksrc[i]);
+            vdst[pos] = std::move(vsrc[i]);
+        }
+    };
+
+    std::vector<value_t<KeyIt>> kdev(sz);
+    std::vector<value_t<ValueIt>> vdev(sz);
+    bool in_dev = false; //whether the elements are in kdev and vdev now
+    for (int pass = 0; pass != PASSES; ++pass) {
+        int shift = pass * 8;
+        size_t *cnt = &count[pass * BUCKETS];
+        U bits = detail::radix_bits(in_dev ? kdev[0] : *kfirst);
+        if (cnt[bits >> shift & 0xFF] == static_cast<size_t>(sz))
+            continue;
+
+        size_t sum = 0;
+        for (int r = 0; r != BUCKETS; ++r) {
+            size_t tmp = cnt[r];
+            cnt[r] = sum;
+            sum += tmp;
+        }
+
+        if (in_dev)
+            scatter(kdev.begin(), vdev.begin(), kfirst, vfirst, shift, cnt);
+        else
+            scatter(kfirst, vfirst, kdev.begin(), vdev.begin(), shift, cnt);
+        in_dev = !in_dev;
+    }
+
+    if (in_dev) {
+        std::move(kdev.begin(), kdev.end(), kfirst);
+        std::move(vdev.begin(), vdev.end(), vfirst);
+    }
+}
+}
+
+/**
+ * argsort(stable):
+ *  indices which order the elements by the key extracted from them, the range is not changed
+ *  the key and index of every element are sorted together as one record: radix sort for
+ *  integral and floating keys, merge sort for other keys
+ *  time complexity: O(w*(n+256)) for radix keys, O(nlogn) for other keys
+ *  space complexity: O(n)
+ * @param first: iterator of the first element, there should be less than 2^32 elements
+ * @param last: iterator after the last element
+ * @param key: key extractor
+ * return: perm, first[perm[0]], first[perm[1]], ... are ordered
+ */
+template<typename It, typename Key = identity>
+std::vector<uint32_t> argsort(It first, It last, Key key = Key()) {
+    using K = typename std::decay<decltype(key(*first))>::type;
+    return detail::argsort(first, last, key, detail::is_radix_key<K>());
+}
+
+/**
+ * reorder a range by a permutation: the ith element becomes first[perm[i]]
+ *  apply the permutation of argsort to every column of a table
+ *  time complexity: O(n)
+ *  space complexity: O(n)
+ */
+template<typename It>
+void apply_permutation(It first, const std::vector<uint32_t> &perm) {
+    std::vector<detail::value_t<It>> dev(perm.size());
+    for (size_t i = 0; i != perm.size(); ++i)
+        dev[i] = std::move(first[perm[i]]);
+    std::move(dev.begin(), dev.end(), first);
+}
+
+namespace detail {
+template<typename KeyIt, typename ValueIt>
+void sort_pairs(KeyIt kfirst, KeyIt klast, ValueIt vfirst, std::true_type) {
+    detail::radix_sort_pairs(kfirst, klast, vfirst);
+}
+
+template<typename KeyIt, typename ValueIt>
+void sort_pairs(KeyIt kfirst, KeyIt klast, ValueIt vfirst, std::false_type) {
+    auto perm = algo::argsort(kfirst, klast);
+    algo::apply_permutation(kfirst, perm);
+    algo::apply_permutation(vfirst, perm);
+}
+}
+
+/**
+ * sort a key array and a value array together by the keys(stable)
+ *  values of radix keys up to 8 bytes: radix sort of split arrays, both arrays are
+ *  scattered every pass, no index is needed
+ *  larger values and other keys: argsort the keys, then gather every array once, so a
+ *  large value is moved twice instead of once every pass
+ *  time complexity: O(w*(n+256)) for radix keys, O(nlogn) for other keys
+ *  space complexity: O(n)
+ * @param kfirst: iterator of the first key
+ * @param klast: iterator after the last key
+ * @param vfirst: iterator of the value of the first key
+ * return: none
+ */
+template<typename KeyIt, typename ValueIt>
+void sort_pairs(KeyIt kfirst, KeyIt klast, ValueIt vfirst) {
+    using K = detail::value_t<KeyIt>;
+    if (klast - kfirst < 2) return;
+    detail::sort_pairs(kfirst, klast, vfirst, std::integral_constant<bool,
+            detail::is_radix_key<K>::value && sizeof(detail::value_t<ValueIt>) <= 8>());
+}
+
+namespace detail {
+/**
+ * string with the 8 bytes from the current depth cached in big-endian order,
+ * comparing the caches compares the strings at these bytes without reading the string
+ */
+struct string_item {
+    uint64_t cache;
+    std::string *str;
+};
+
+/**
+ * 8 bytes of s from depth in big-endian order, padded by zeros after the end
+ */
+inline uint64_t string_chunk(const std::string &s, size_t depth) {
+    const auto *p = reinterpret_cast<const unsigned char *>(s.data()) + depth;
+    size_t len = s.size() - depth;
+    uint64_t key = 0;
+    if (len >= 8)
+        return uint64_t(p[0]) << 56 | uint64_t(p[1]) << 48 | uint64_t(p[2]) << 40 | uint64_t(p[3]) << 32
+               | uint64_t(p[4]) << 24 | uint64_t(p[5]) << 16 | uint64_t(p[6]) << 8 | uint64_t(p[7]);
+    for (size_t i = 0; i != len; ++i)
+        key |= uint64_t(p[i]) << (56 - 8 * i);
+    return key;
+}
+
+/**
+ * items share the first depth bytes, compare the caches first, then the rest of the strings
+ */
+inline int string_compare(const string_item &a, const string_item &b, size_t depth) {
+    if (a.cache != b.cache) return a.cache < b.cache ? -1 : 1;
+    return a.str->compare(depth, std::string::npos, *b.str, depth, std::string::npos);
+}
+
+/**
+ * sort a small group or a group which the caches can't tell apart by comparisons,
+ * mark the strings equal to their predecessors
+ */
+inline void string_sort_compare(string_item *first, string_item *last, size_t depth, char *dup) {
+    auto less = [depth](const string_item &a, const string_item &b) { return string_compare(a, b, depth) < 0; };
+    if (last - first <= 16)
+        algo::insert_sort(first, last, less);
+    else
+        std::sort(first, last, less);
+    for (string_item *it = first + 1; it < last; ++it)
+        dup[it - first] = string_compare(*(it - 1), *it, depth) == 0;
+}
+
+/**
+ * the chunk at depth ends the strings of a group with equal caches,
+ * they are equal if they end at the same position
+ */
+inline void string_sort_ended(string_item *first, string_item *last, size_t depth, char *dup) {
+    bool equal = first->str->size() <= depth + 8;
+    for (string_item *it = first + 1; it != last && equal; ++it)
+        equal = it->str->size() == first->str->size();
+    if (equal)
+        std::fill(dup + 1, dup + (last - first), 1);
+    else //zero bytes inside some strings
+        detail::string_sort_compare(first, last, depth, dup);
+}
+
+/**
+ * multikey quick sort: three-way partition by the caches of depth
+ *  less and greater parts are sorted at the same depth
+ *  the equal part shares 8 more bytes: go 8 bytes deeper and refresh its caches, or stop
+ *  if the chunk ends the strings, then they are duplicates of each other
+ *  the two smaller parts are sorted recursively and the largest one by the loop, like
+ *  quick_sort, so the recursion depth is O(logn)
+ */
+inline void string_sort_child(string_item *first, string_item *last, size_t depth, char *dup) {
+    struct Part {
+        string_item *first, *last;
+        size_t depth;
+    };
+
+    while (last - first > 1) {
+        if (last - first <= 16) {
+            detail::string_sort_compare(first, last, depth, dup);
+            return;
+        }
+
+        uint64_t a = first->cache, b = first[(last - first) / 2].cache, c = (last - 1)->cache;
+        uint64_t pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+
+        //[first, lt) < pivot, [lt, i) == pivot, [gt, last) > pivot
+        string_item *lt = first, *i = first, *gt = last;
+        while (i < gt) {
+            if (i->cache < pivot)
+                std::swap(*lt++, *i++);
+            else if (i->cache > pivot)
+                std::swap(*i, *--gt);
+            else
+                ++i;
+        }
+
+        Part parts[3] = {{first, lt, depth}, {lt, gt, depth + 8}, {gt, last, depth}};
+        if (pivot & 0xFF) { //all strings of the equal part go on after the chunk
+            for (string_item *it = lt; it != gt; ++it)
+                it->cache = detail::string_chunk(*it->str, depth + 8);
+        } else {
+            detail::string_sort_ended(lt, gt, depth, dup + (lt - first));
+            parts[1].last = lt;
+        }
+
+        int largest = 0;
+        for (int k = 1; k != 3; ++k)
+            if (parts[k].last - parts[k].first > parts[largest].last - parts[largest].first)
+                largest = k;
+        for (int k = 0; k != 3; ++k)
+            if (k != largest)
+                detail::string_sort_child(parts[k].first, parts[k].last, parts[k].depth,
+                                          dup + (parts[k].first - first));
+
+        dup += parts[largest].first - first;
+        first = parts[largest].first;
+        last = parts[largest].last;
+        depth = parts[largest].depth;
+    }
+}
+}
+
+/**
+ * string sort(not stable):
+ *  multikey quick sort on 8-byte chunks: every string caches the chunk at the current depth,
+ *  so partitions compare integers in a contiguous array instead of reading the strings,
+ *  a string is read only when its group goes 8 bytes deeper, the common prefix of a group
+ *  is never compared again
+ *  duplicates end in the same group of equal chunks, they can be removed in the same pass
+ *  time complexity: O(nlogn + D/8), D - total length of the distinguishing prefixes
+ *  space complexity: O(n)
+ * @param words: strings to sort
+ * @param dedup: keep only one of the equal strings
+ * return: none
+ */
+inline void string_sort(std::vector<std::string> &words, bool dedup = false) {
+    size_t sz = words.size();
+    std::vector<detail::string_item> items(sz);
+    for (size_t i = 0; i != sz; ++i)
+        items[i] = {detail::string_chunk(words[i], 0), &words[i]};
+    std::vector<char> dup(sz, 0);
+    detail::string_sort_child(items.data(), items.data() + sz, 0, dup.data());
+
+    std::vector<std::string> res;
+    res.reserve(sz);
+    for (size_t i = 0; i != sz; ++i)
+        if (!dedup || !dup[i])
+            res.push_back(std::move(*items[i].str));
+    words.swap(res);
+}
+
+}
+
+#endif //ALGORITHMS_SORT_H